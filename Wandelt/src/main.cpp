@@ -23,13 +23,26 @@ int main(int argc, char* argv[])
 	ASSERT(argc > 1, "No input file provided. Usage: Wandelt.exe <input file> <output file>");
 	ASSERT(argc > 2, "No output file provided. Usage: Wandelt.exe <input file> <output file>");
 
-	bool hasFlags = argc > 3;
-
 	CompilerArguments args;
 	args.InputFile  = *(argv + 1);
 	args.OutputFile = *(argv + 2);
-	args.Flags      = hasFlags ? (strcmp(*(argv + 3), "--v") == 0 ? CompilerFlags::Verbose : CompilerFlags::None)
-	                           : CompilerFlags::None;
+
+	// --v for verbose output, --cache=<directory> to keep parsed ASTs between runs, --share-expressions to generate
+	// repeated pure expressions once, --error-limit=<count> to stop after that many syntax errors, 0 for no limit,
+	// --checked-arithmetic to trap on overflowing arithmetic and divisions by 0.
+	for (int i = 3; i < argc; i++)
+	{
+		if (strcmp(*(argv + i), "--v") == 0)
+			args.Flags = static_cast<CompilerFlags>(args.Flags | CompilerFlags::Verbose);
+		else if (strcmp(*(argv + i), "--share-expressions") == 0)
+			args.Flags = static_cast<CompilerFlags>(args.Flags | CompilerFlags::ShareExpressions);
+		else if (strcmp(*(argv + i), "--checked-arithmetic") == 0)
+			args.Flags = static_cast<CompilerFlags>(args.Flags | CompilerFlags::CheckedArithmetic);
+		else if (strncmp(*(argv + i), "--cache=", 8) == 0)
+			args.CacheDirectory = *(argv + i) + 8;
+		else if (strncmp(*(argv + i), "--error-limit=", 14) == 0)
+			args.ErrorLimit = static_cast<u32>(strtoul(*(argv + i) + 14, nullptr, 10));
+	}
 
 	// args.InputFile  = "../WandeltExamples/simple.wdt";
 	// args.OutputFile = "output.exe";
@@ -8,7 +8,7 @@
  */
 #pragma once
 
-#include "Core/AST/Visitor.hpp"
+#include "Core/AST/AstArena.hpp"
 #include "Core/Lexer/Token.hpp"
 
 namespace WandeltCore
@@ -20,73 +20,137 @@ namespace WandeltCore
 	//    UnaryExpression
 	//    PowerExpression
 	//    GroupingExpression
+	//    VariableExpression
 	//  Type
 	//  ReturnStatement
 	//  IfStatement
 	//  DeclarationStatement
 	//   VariableDeclaration
 	//   FunctionDeclaration
-	class Dumpable
+	//
+	// Nodes are created in an AstArena and never destroyed one by one, so they have to stay trivially
+	// destructible. Child lists are spans into the arena. This is the tree the parser builds, the later
+	// phases work on the FlatAst it is lowered into.
+	enum class NodeKind : u8
 	{
-	public:
-		virtual void Dump(u32 indentation = 0) const = 0;
+		NumberLiteral,
+		BinaryExpression,
+		UnaryExpression,
+		PowerExpression,
+		GroupingExpression,
+		VariableExpression,
+		CallExpression,
+		Declaration,
+		VariableDeclaration,
+		Scope,
+		IfStatement,
+		ReturnStatement,
+	};
+
+	// Whether nodes of the kind have a value. The expression kinds come first.
+	constexpr bool IsExpression(NodeKind kind)
+	{
+		return kind <= NodeKind::CallExpression;
+	}
+
+	// Whether nodes of the kind are expressions without side effects. Calls are not, println prints.
+	constexpr bool IsPureExpression(NodeKind kind)
+	{
+		return kind < NodeKind::CallExpression;
+	}
+
+	// The type of the value of an expression. Comparisons are Bool, i1 in codegen, all other values are i32.
+	// Statements have no value.
+	enum class ValueType : u8
+	{
+		None,
+		Bool,
+		Int32,
+	};
+
+	// What Sema proved about the arithmetic of a binary, unary or power expression. Codegen flags the instructions
+	// with it and leaves out the runtime checks it makes unnecessary.
+	enum class ArithmeticFact : u8
+	{
+		NoSignedWrap       = 1 << 0, // The result fits into an i32
+		NoUnsignedWrap     = 1 << 1, // The result fits into a u32 too, operands and result are not negative
+		NonZeroDivisor     = 1 << 2, // The right side of a division or remainder is not 0
+		NoDivisionOverflow = 1 << 3, // No INT_MIN is divided by -1
 	};
 
-	class Statement : public Dumpable
+	// A set of ArithmeticFact bits.
+	using ArithmeticFacts = u8;
+
+	constexpr ArithmeticFacts AllArithmeticFacts = 0b1111;
+
+	// Sema numbers the variables of a program in declaration order, every read refers to its declaration by the
+	// number.
+	using VariableID = u32;
+
+	constexpr VariableID InvalidVariableID = std::numeric_limits<VariableID>::max();
+
+	class Statement
 	{
 	public:
-		explicit Statement(const SourceLocation& location) : m_Location(location) {}
-		virtual ~Statement() = default;
+		Statement(const SourceLocation& location, NodeKind kind) : m_Location(location), m_Kind(kind) {}
 
 		const SourceLocation& GetLocation() const { return m_Location; }
+		NodeKind GetKind() const { return m_Kind; }
 
-		virtual llvm::Value* Generate(Visitor* visitor) = 0;
+		// Move the node by delta bytes, for reusing it after an edit in front of it.
+		void ShiftLocation(i32 delta) { m_Location.Offset += delta; }
 
 	private:
 		SourceLocation m_Location;
+		NodeKind m_Kind;
 	};
 
 	class Expression : public Statement
 	{
 	public:
-		explicit Expression(const SourceLocation& location) : Statement(location) {}
+		Expression(const SourceLocation& location, NodeKind kind) : Statement(location, kind) {}
+
+		// The type of the value, Int32 until Sema inferred it.
+		ValueType GetType() const { return m_Type; }
+		void SetType(ValueType type) { m_Type = type; }
+
+		// What Sema proved about the arithmetic of the expression, nothing until it analyzed the ranges.
+		ArithmeticFacts GetFacts() const { return m_Facts; }
+		void AddFact(ArithmeticFact fact) { m_Facts |= static_cast<ArithmeticFacts>(fact); }
+
+	private:
+		ValueType m_Type        = ValueType::Int32;
+		ArithmeticFacts m_Facts = 0;
 	};
 
 	class NumberLiteral : public Expression
 	{
 	public:
-		explicit NumberLiteral(const SourceLocation& location, i32 value) : Expression(location), m_Value(value) {}
-
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GenerateNumberLiteral(this); }
-
-		void Dump(u32 indentation = 0) const override;
+		explicit NumberLiteral(const SourceLocation& location, u64 value)
+		    : Expression(location, NodeKind::NumberLiteral), m_Value(value)
+		{
+		}
 
-		i32 GetValue() const { return m_Value; }
+		u64 GetValue() const { return m_Value; }
 
 	private:
-		i32 m_Value;
+		u64 m_Value;
 	};
 
 	class BinaryExpression : public Expression
 	{
 	public:
 		explicit BinaryExpression(const SourceLocation& location, Expression* left, Expression* right, TokenType op)
-		    : Expression(location), m_Left(left), m_Right(right), m_Operator(op)
+		    : Expression(location, NodeKind::BinaryExpression), m_Left(left), m_Right(right), m_Operator(op)
 		{
 		}
-		~BinaryExpression() override
-		{
-			delete m_Left;
-			delete m_Right;
-		}
-
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GenerateBinaryExpression(this); }
-
-		void Dump(u32 indentation = 0) const override;
 
 		Expression* GetLeft() const { return m_Left; }
 		Expression* GetRight() const { return m_Right; }
 
+		void SetLeft(Expression* left) { m_Left = left; }
+		void SetRight(Expression* right) { m_Right = right; }
+
 		TokenType GetOperator() const { return m_Operator; }
 
 	private:
@@ -100,16 +164,12 @@ namespace WandeltCore
 	{
 	public:
 		explicit UnaryExpression(const SourceLocation& location, Expression* operand, TokenType op)
-		    : Expression(location), m_Operand(operand), m_Operator(op)
+		    : Expression(location, NodeKind::UnaryExpression), m_Operand(operand), m_Operator(op)
 		{
 		}
-		~UnaryExpression() override { delete m_Operand; }
-
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GenerateUnaryExpression(this); }
-
-		void Dump(u32 indentation = 0) const override;
 
 		Expression* GetOperand() const { return m_Operand; }
+		void SetOperand(Expression* operand) { m_Operand = operand; }
 
 		TokenType GetOperator() const { return m_Operator; }
 
@@ -122,22 +182,16 @@ namespace WandeltCore
 	{
 	public:
 		explicit PowerExpression(const SourceLocation& location, Expression* base, Expression* exponent)
-		    : Expression(location), m_Base(base), m_Exponent(exponent)
-		{
-		}
-		~PowerExpression() override
+		    : Expression(location, NodeKind::PowerExpression), m_Base(base), m_Exponent(exponent)
 		{
-			delete m_Base;
-			delete m_Exponent;
 		}
 
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GeneratePowerExpression(this); }
-
-		void Dump(u32 indentation = 0) const override;
-
 		Expression* GetBase() const { return m_Base; }
 		Expression* GetExponent() const { return m_Exponent; }
 
+		void SetBase(Expression* base) { m_Base = base; }
+		void SetExponent(Expression* exponent) { m_Exponent = exponent; }
+
 	private:
 		Expression* m_Base     = nullptr;
 		Expression* m_Exponent = nullptr;
@@ -147,63 +201,72 @@ namespace WandeltCore
 	{
 	public:
 		explicit GroupingExpression(const SourceLocation& location, Expression* expression)
-		    : Expression(location), m_Expression(expression)
+		    : Expression(location, NodeKind::GroupingExpression), m_Expression(expression)
 		{
 		}
-		~GroupingExpression() override { delete m_Expression; }
-
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GenerateGroupingExpression(this); }
-
-		void Dump(u32 indentation = 0) const override;
 
 		Expression* GetExpression() const { return m_Expression; }
+		void SetExpression(Expression* expression) { m_Expression = expression; }
 
 	private:
 		Expression* m_Expression = nullptr;
 	};
 
-	class Scope : public Dumpable
+	class VariableExpression : public Expression
 	{
 	public:
-		explicit Scope(const SourceLocation& location, const std::vector<Statement*>& statements)
+		explicit VariableExpression(const SourceLocation& location, SymbolID name)
+		    : Expression(location, NodeKind::VariableExpression), m_Name(name)
+		{
+		}
+
+		SymbolID GetName() const { return m_Name; }
+
+		// The variable the name refers to, InvalidVariableID until Sema resolved it.
+		VariableID GetVariable() const { return m_Variable; }
+		void SetVariable(VariableID variable) { m_Variable = variable; }
+
+	private:
+		SymbolID m_Name;
+		VariableID m_Variable = InvalidVariableID;
+	};
+
+	class Scope
+	{
+	public:
+		explicit Scope(const SourceLocation& location, std::span<Statement*> statements)
 		    : m_Location(location), m_Statements(statements)
 		{
 		}
 
 		const SourceLocation& GetLocation() const { return m_Location; }
-		const std::vector<Statement*>& GetStatements() const { return m_Statements; }
+		std::span<Statement*> GetStatements() const { return m_Statements; }
+		void SetStatements(std::span<Statement*> statements) { m_Statements = statements; }
 
-		void Dump(u32 indentation = 0) const override;
+		void ShiftLocation(i32 delta) { m_Location.Offset += delta; }
 
 	private:
 		SourceLocation m_Location;
-		std::vector<Statement*> m_Statements;
+		std::span<Statement*> m_Statements; // Stored in the AstArena
 	};
 
 	class IfStatement : public Statement
 	{
 	public:
 		IfStatement(const SourceLocation& location, Expression* condition, Scope* thenScope, Scope* elseScope)
-		    : Statement(location), m_Condition(condition), m_ThenScope(thenScope), m_ElseScope(elseScope)
-		{
-		}
-		~IfStatement() override
+		    : Statement(location, NodeKind::IfStatement), m_Condition(condition), m_ThenScope(thenScope),
+		      m_ElseScope(elseScope)
 		{
-			delete m_Condition;
-			delete m_ThenScope;
-			delete m_ElseScope;
 		}
 
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GenerateIfStatement(this); }
-
-		void Dump(u32 indentation = 0) const override;
-
 		bool HasElseScope() const { return m_ElseScope != nullptr; }
 
 		Expression* GetCondition() const { return m_Condition; }
 		Scope* GetThenScope() const { return m_ThenScope; }
 		Scope* GetElseScope() const { return m_ElseScope; }
 
+		void SetCondition(Expression* condition) { m_Condition = condition; }
+
 	private:
 		Expression* m_Condition = nullptr;
 		Scope* m_ThenScope      = nullptr;
@@ -214,16 +277,12 @@ namespace WandeltCore
 	{
 	public:
 		explicit ReturnStatement(const SourceLocation& location, Expression* expression)
-		    : Statement(location), m_Expression(expression)
+		    : Statement(location, NodeKind::ReturnStatement), m_Expression(expression)
 		{
 		}
-		~ReturnStatement() override { delete m_Expression; }
-
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GenerateReturnStatement(this); }
-
-		void Dump(u32 indentation = 0) const override;
 
 		Expression* GetExpression() const { return m_Expression; }
+		void SetExpression(Expression* expression) { m_Expression = expression; }
 
 	private:
 		Expression* m_Expression = nullptr;
@@ -232,35 +291,65 @@ namespace WandeltCore
 	class Declaration : public Statement
 	{
 	public:
-		Declaration(SourceLocation location, std::string identifer) : Statement(location), m_Identifier(identifer) {}
+		Declaration(SourceLocation location, SymbolID identifier)
+		    : Statement(location, NodeKind::Declaration), m_Identifier(identifier)
+		{
+		}
 
-		const std::string& GetIdentifier() { return m_Identifier; }
+		SymbolID GetIdentifier() const { return m_Identifier; }
+		std::string_view GetIdentifierName() const { return StringInterner::Get().GetString(m_Identifier); }
 
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GenerateDeclaration(this); }
+	private:
+		SymbolID m_Identifier;
+	};
 
-		void Dump(u32 indentation = 0) const override;
+	// let $name = initializer;
+	class VariableDeclaration : public Statement
+	{
+	public:
+		VariableDeclaration(const SourceLocation& location, SymbolID name, Expression* initializer)
+		    : Statement(location, NodeKind::VariableDeclaration), m_Name(name), m_Initializer(initializer)
+		{
+		}
+
+		SymbolID GetName() const { return m_Name; }
+
+		Expression* GetInitializer() const { return m_Initializer; }
+		void SetInitializer(Expression* initializer) { m_Initializer = initializer; }
+
+		// The number Sema gave the variable, InvalidVariableID until then.
+		VariableID GetVariable() const { return m_Variable; }
+		void SetVariable(VariableID variable) { m_Variable = variable; }
 
 	private:
-		std::string m_Identifier;
+		SymbolID m_Name;
+		Expression* m_Initializer = nullptr;
+		VariableID m_Variable     = InvalidVariableID;
 	};
 
 	class CallExpression : public Expression
 	{
 	public:
-		CallExpression(SourceLocation location, Declaration* declaration, const std::vector<Expression*>& args)
-		    : Expression(location), m_Declaration(declaration), m_Args(args)
+		CallExpression(SourceLocation location, Declaration* declaration, std::span<Expression*> args)
+		    : Expression(location, NodeKind::CallExpression), m_Declaration(declaration), m_Args(args)
 		{
 		}
 
 		Declaration* GetDeclaration() const { return m_Declaration; }
-		const std::vector<Expression*>& GetArgs() const { return m_Args; }
+		std::span<Expression*> GetArgs() const { return m_Args; }
 
-		llvm::Value* Generate(Visitor* visitor) override { return visitor->GenerateCallExpression(this); }
-
-		void Dump(u32 indentation = 0) const override;
+		// The name of the called function.
+		SymbolID GetCallee() const { return m_Declaration->GetIdentifier(); }
 
 	private:
 		Declaration* m_Declaration = nullptr;
-		std::vector<Expression*> m_Args;
+		std::span<Expression*> m_Args; // Stored in the AstArena
+	};
+
+	// A parsed compilation unit. Owns the arena all of its nodes live in, move it to hand it on.
+	struct Ast
+	{
+		AstArena Arena;
+		std::vector<Statement*> Statements; // The top level statements in source order
 	};
 } // namespace WandeltCore
@@ -0,0 +1,64 @@
+#include "AstArena.hpp"
+
+namespace WandeltCore
+{
+	AstArena::AstArena(AstArena&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	AstArena& AstArena::operator=(AstArena&& other) noexcept
+	{
+		m_Chunks        = std::move(other.m_Chunks);
+		m_Cursor        = std::exchange(other.m_Cursor, nullptr);
+		m_End           = std::exchange(other.m_End, nullptr);
+		m_UsedBytes     = std::exchange(other.m_UsedBytes, 0);
+		m_ReservedBytes = std::exchange(other.m_ReservedBytes, 0);
+
+		other.m_Chunks.clear();
+
+		return *this;
+	}
+
+	void AstArena::Adopt(AstArena&& other)
+	{
+		// The adopted chunks go behind the one allocated from, which stays the one to allocate from.
+		m_Chunks.insert(m_Chunks.end(), std::make_move_iterator(other.m_Chunks.begin()),
+		                std::make_move_iterator(other.m_Chunks.end()));
+
+		m_UsedBytes += other.m_UsedBytes;
+		m_ReservedBytes += other.m_ReservedBytes;
+
+		other = AstArena();
+	}
+
+	void* AstArena::Allocate(size_t size, size_t alignment)
+	{
+		std::byte* aligned = m_Cursor;
+
+		if (aligned)
+		{
+			const uintptr_t address = reinterpret_cast<uintptr_t>(aligned);
+			aligned += (alignment - address % alignment) % alignment;
+		}
+
+		if (!aligned || aligned + size > m_End)
+		{
+			// Allocations larger than a chunk get a chunk of their own.
+			const size_t chunkSize = std::max(size + alignment, ChunkSize);
+
+			m_Chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(chunkSize));
+			m_ReservedBytes += chunkSize;
+
+			const uintptr_t address = reinterpret_cast<uintptr_t>(m_Chunks.back().get());
+
+			aligned = m_Chunks.back().get() + (alignment - address % alignment) % alignment;
+			m_End   = m_Chunks.back().get() + chunkSize;
+		}
+
+		m_Cursor = aligned + size;
+		m_UsedBytes += size;
+
+		return aligned;
+	}
+} // namespace WandeltCore
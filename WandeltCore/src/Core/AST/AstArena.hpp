@@ -0,0 +1,72 @@
+/**
+ * @file AstArena.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+namespace WandeltCore
+{
+	// Bump-pointer allocator the AST of a compilation unit lives in. Nodes are trivially destructible,
+	// so nothing is destroyed one by one, freeing the arena releases whole chunks at once.
+	class AstArena
+	{
+	public:
+		AstArena() = default;
+
+		AstArena(const AstArena&)            = delete;
+		AstArena& operator=(const AstArena&) = delete;
+
+		// Moving hands over the chunks, nodes keep their addresses.
+		AstArena(AstArena&& other) noexcept;
+		AstArena& operator=(AstArena&& other) noexcept;
+
+		template <typename T, typename... Args>
+		T* Create(Args&&... args)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "Arena allocated nodes are never destroyed.");
+
+			return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		// Copy the elements into the arena, for child lists of nodes.
+		template <typename T>
+		std::span<T> CopyArray(std::span<const T> elements)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Arena arrays are copied bytewise.");
+
+			if (elements.empty())
+				return {};
+
+			T* data = static_cast<T*>(Allocate(elements.size_bytes(), alignof(T)));
+			std::memcpy(data, elements.data(), elements.size_bytes());
+
+			return {data, elements.size()};
+		}
+
+		// Take over the chunks of the other arena, which is empty afterwards. Nodes keep their addresses, so
+		// ASTs built in separate arenas can be merged into one without copying.
+		void Adopt(AstArena&& other);
+
+		// Bytes handed out and bytes reserved in chunks, for statistics.
+		size_t GetUsedBytes() const { return m_UsedBytes; }
+		size_t GetReservedBytes() const { return m_ReservedBytes; }
+
+	private:
+		void* Allocate(size_t size, size_t alignment);
+
+	private:
+		static constexpr size_t ChunkSize = 64 * 1024;
+
+		std::vector<std::unique_ptr<std::byte[]>> m_Chunks;
+
+		std::byte* m_Cursor = nullptr; // Next free byte in the chunk allocated from
+		std::byte* m_End    = nullptr; // End of the chunk allocated from
+
+		size_t m_UsedBytes     = 0;
+		size_t m_ReservedBytes = 0;
+	};
+} // namespace WandeltCore
@@ -0,0 +1,965 @@
+#include "FlatAst.hpp"
+
+#include <algorithm>
+
+namespace WandeltCore
+{
+	namespace
+	{
+		constexpr u32 SerializedMagic   = 0x54534157; // "WAST" when read as little endian bytes
+		constexpr u32 SerializedVersion = 4;
+
+		// Followed by the literals, the symbol lengths and characters, the child lists, the nodes, their types and
+		// the top level statements. Calls and variables refer to their name by its index in the symbol list.
+		struct SerializedHeader
+		{
+			u32 Magic;
+			u32 Version;
+			u32 VariableCount;
+			u32 LiteralCount;
+			u32 SymbolCount;
+			u32 SymbolBytes; // Characters of all symbols together
+			u32 ChildCount;
+			u32 NodeCount;
+			u32 StatementCount;
+		};
+
+		// Kinds that can stand in a scope or at the top level. Scopes only belong to if statements.
+		bool IsStatementKind(NodeKind kind)
+		{
+			return IsExpression(kind) || kind == NodeKind::VariableDeclaration || kind == NodeKind::IfStatement ||
+			       kind == NodeKind::ReturnStatement;
+		}
+
+		bool IsBinaryOperator(TokenType type)
+		{
+			return type == TokenType::PLUS || type == TokenType::MINUS || type == TokenType::STAR ||
+			       type == TokenType::SLASH || type == TokenType::PERCENT || IsComparisonOperator(type);
+		}
+
+		// Names of variables and functions are made of letters, digits and '$', like the lexer reads them.
+		bool IsIdentifierName(std::string_view name)
+		{
+			return !name.empty() && std::all_of(name.begin(), name.end(), [](char c) {
+				return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '$';
+			});
+		}
+
+		template <typename T>
+		void Append(std::string& out, const T* data, size_t count)
+		{
+			out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+		}
+
+		// Hash of what makes expression nodes equal: the kind, the operator and the children, or the value of a
+		// literal. The source location is left out.
+		u32 HashNode(const FlatNode& node, u64 literal)
+		{
+			constexpr u64 multiplier = 0x9E3779B97F4A7C15ull;
+
+			u64 hash = (u64(node.Kind) << 8 | u64(node.Operator)) * multiplier;
+
+			const auto mix = [&hash](u64 word) {
+				hash = (hash ^ word) * multiplier;
+				hash ^= hash >> 32;
+			};
+
+			if (node.Kind == NodeKind::NumberLiteral)
+			{
+				mix(literal);
+			}
+			else
+			{
+				mix(u64(node.Operands[0]) | u64(node.Operands[1]) << 32);
+				mix(node.Operands[2]);
+			}
+
+			return static_cast<u32>(hash);
+		}
+
+		// Reads consecutive arrays from the data, the caller checks the total size up front.
+		class Reader
+		{
+		public:
+			explicit Reader(std::string_view data) : m_Data(data) {}
+
+			template <typename T>
+			void Read(T* data, size_t count)
+			{
+				std::memcpy(data, m_Data.data() + m_Offset, count * sizeof(T));
+				m_Offset += count * sizeof(T);
+			}
+
+			std::string_view ReadString(size_t size)
+			{
+				const std::string_view result = m_Data.substr(m_Offset, size);
+				m_Offset += size;
+
+				return result;
+			}
+
+			size_t GetRemaining() const { return m_Data.size() - m_Offset; }
+
+		private:
+			std::string_view m_Data;
+			size_t m_Offset = 0;
+		};
+
+		// Prints every node on a line of its own, indented below its parent.
+		class AstDumper
+		{
+		public:
+			explicit AstDumper(const FlatAst& ast) : m_Ast(ast) {}
+
+			bool Enter(const WalkStep& step)
+			{
+				u32 indentation = 0;
+
+				// Arguments are indented twice, the parts of an if get a label in between.
+				if (step.Parent != InvalidNodeIndex)
+				{
+					const u32 parentIndentation = m_Indentations[step.Depth - 1];
+
+					switch (m_Ast.GetNode(step.Parent).Kind)
+					{
+					case NodeKind::CallExpression:
+						indentation = parentIndentation + 2;
+						break;
+					case NodeKind::IfStatement:
+					{
+						constexpr std::array<const char*, 3> labels = {"Condition: ", "Then: ", "Else: "};
+
+						SYSTEM_DEBUG(getIndent(parentIndentation + 1) + labels[step.Slot]);
+
+						indentation = parentIndentation + 2;
+						break;
+					}
+					default:
+						indentation = parentIndentation + 1;
+						break;
+					}
+				}
+
+				m_Indentations.resize(step.Depth + 1);
+				m_Indentations[step.Depth] = indentation;
+
+				if (step.Node == InvalidNodeIndex)
+				{
+					SYSTEM_DEBUG(getIndent(indentation) + "nullptr");
+
+					return false;
+				}
+
+				const FlatNode& node = m_Ast.GetNode(step.Node);
+
+				switch (node.Kind)
+				{
+				case NodeKind::NumberLiteral:
+					SYSTEM_DEBUG(getIndent(indentation) + "NumberLiteral: '" +
+					             std::to_string(static_cast<i64>(m_Ast.GetLiteral(node))) + "'");
+					break;
+				case NodeKind::BinaryExpression:
+					SYSTEM_DEBUG(getIndent(indentation) + "BinaryExpression: '" +
+					             std::string(TokenTypeToStringRepresentation(node.Operator)) + "'");
+					break;
+				case NodeKind::UnaryExpression:
+					SYSTEM_DEBUG(getIndent(indentation) + "UnaryExpression: '" +
+					             std::string(TokenTypeToStringRepresentation(node.Operator)) + "'");
+					break;
+				case NodeKind::PowerExpression:
+					SYSTEM_DEBUG(getIndent(indentation) + "PowerExpression: ");
+					break;
+				case NodeKind::GroupingExpression:
+					SYSTEM_DEBUG(getIndent(indentation) + "GroupingExpression: ");
+					break;
+				case NodeKind::VariableExpression:
+					SYSTEM_DEBUG(getIndent(indentation) + "VariableExpression: '" +
+					             std::string(StringInterner::Get().GetString(node.Operands[1])) + "'");
+					break;
+				case NodeKind::CallExpression:
+					SYSTEM_DEBUG(getIndent(indentation) + "CallExpression: ");
+					SYSTEM_DEBUG(getIndent(indentation + 1) + "Declaration: ");
+					SYSTEM_DEBUG(getIndent(indentation + 2) + "Identifier: {}",
+					             StringInterner::Get().GetString(node.Operands[0]));
+					SYSTEM_DEBUG(getIndent(indentation) + "Args: ");
+					break;
+				case NodeKind::Scope:
+					SYSTEM_DEBUG(getIndent(indentation) + "Scope: ");
+					break;
+				case NodeKind::IfStatement:
+					SYSTEM_DEBUG(getIndent(indentation) + "IfStatement: ");
+					break;
+				case NodeKind::ReturnStatement:
+					SYSTEM_DEBUG(getIndent(indentation) + "ReturnStatement: ");
+					break;
+				case NodeKind::VariableDeclaration:
+					SYSTEM_DEBUG(getIndent(indentation) + "VariableDeclaration: '" +
+					             std::string(StringInterner::Get().GetString(node.Operands[2])) + "'");
+					break;
+				default:
+					SYSTEM_DEBUG(getIndent(indentation) + "Unknown node");
+					return false;
+				}
+
+				return true;
+			}
+
+			void Leave(const WalkStep&) {}
+
+		private:
+			const FlatAst& m_Ast;
+
+			std::vector<u32> m_Indentations; // Of the nodes on the path from the root to the current one
+		};
+	} // namespace
+
+	FlatAst FlatAst::Lower(std::span<Statement* const> statements, bool shareExpressions)
+	{
+		FlatAst ast;
+
+		// Post-order with an explicit stack, so deeply nested input can not overflow the call stack. A node is
+		// lowered after its children, their indices are collected on the lowered stack in source order.
+		struct Entry
+		{
+			const Statement* Node;
+			const Scope* ScopeNode; // Set instead of Node for scopes, both are nullptr for missing children
+			bool IsExpanded;        // Whether the children were pushed already
+		};
+
+		std::vector<Entry> stack;
+
+		LowerState state;
+		std::vector<NodeIndex>& lowered = state.Lowered;
+
+		if (shareExpressions)
+		{
+			state.ShareExpressions = true;
+			state.SharedSlots.resize(1024);
+		}
+
+		// Children are pushed last to first, so they come off the stack in source order.
+		const auto pushStatement = [&](const Statement* statement) { stack.push_back({statement, nullptr, false}); };
+		const auto pushScope     = [&](const Scope* scope) { stack.push_back({nullptr, scope, false}); };
+
+		ast.m_Statements.reserve(statements.size());
+
+		for (const Statement* root : statements)
+		{
+			pushStatement(root);
+
+			while (!stack.empty())
+			{
+				Entry& entry = stack.back();
+
+				if (entry.IsExpanded)
+				{
+					const Entry done = entry;
+					stack.pop_back();
+
+					lowered.push_back(done.ScopeNode ? ast.LowerScope(done.ScopeNode, state)
+					                                 : ast.LowerNode(done.Node, state));
+
+					continue;
+				}
+
+				if (entry.ScopeNode)
+				{
+					entry.IsExpanded = true;
+
+					const std::span<Statement*> children = entry.ScopeNode->GetStatements();
+
+					for (size_t i = children.size(); i-- > 0;) pushStatement(children[i]);
+
+					continue;
+				}
+
+				const Statement* node = entry.Node;
+
+				if (!node)
+				{
+					stack.pop_back();
+					lowered.push_back(InvalidNodeIndex);
+
+					continue;
+				}
+
+				entry.IsExpanded = true;
+
+				switch (node->GetKind())
+				{
+				case NodeKind::BinaryExpression:
+					pushStatement(static_cast<const BinaryExpression*>(node)->GetRight());
+					pushStatement(static_cast<const BinaryExpression*>(node)->GetLeft());
+					break;
+				case NodeKind::UnaryExpression:
+					pushStatement(static_cast<const UnaryExpression*>(node)->GetOperand());
+					break;
+				case NodeKind::PowerExpression:
+					pushStatement(static_cast<const PowerExpression*>(node)->GetExponent());
+					pushStatement(static_cast<const PowerExpression*>(node)->GetBase());
+					break;
+				case NodeKind::GroupingExpression:
+					pushStatement(static_cast<const GroupingExpression*>(node)->GetExpression());
+					break;
+				case NodeKind::CallExpression:
+				{
+					const std::span<Expression*> args = static_cast<const CallExpression*>(node)->GetArgs();
+
+					for (size_t i = args.size(); i-- > 0;) pushStatement(args[i]);
+					break;
+				}
+				case NodeKind::IfStatement:
+					pushScope(static_cast<const IfStatement*>(node)->GetElseScope());
+					pushScope(static_cast<const IfStatement*>(node)->GetThenScope());
+					pushStatement(static_cast<const IfStatement*>(node)->GetCondition());
+					break;
+				case NodeKind::ReturnStatement:
+					pushStatement(static_cast<const ReturnStatement*>(node)->GetExpression());
+					break;
+				case NodeKind::VariableDeclaration:
+					pushStatement(static_cast<const VariableDeclaration*>(node)->GetInitializer());
+					break;
+				default:
+					break;
+				}
+
+				// Literals are lowered as soon as they are next, they need no visit of their own. Most expressions
+				// end in them, so this saves a good part of the trips through the loop.
+				while (!stack.back().IsExpanded && stack.back().Node &&
+				       stack.back().Node->GetKind() == NodeKind::NumberLiteral)
+				{
+					lowered.push_back(ast.LowerNode(stack.back().Node, state));
+					stack.pop_back();
+				}
+			}
+
+			ast.m_Statements.push_back(lowered.back());
+			lowered.pop_back();
+		}
+
+		return ast;
+	}
+
+	std::span<const NodeIndex> FlatAst::GetChildren(const FlatNode& node) const
+	{
+		ASSERT(node.Kind == NodeKind::Scope || node.Kind == NodeKind::CallExpression);
+
+		// Scopes start their list at the first operand, calls keep the callee in front of it.
+		const u32 first = node.Kind == NodeKind::Scope ? 0 : 1;
+
+		return std::span<const NodeIndex>(m_Children).subspan(node.Operands[first], node.Operands[first + 1]);
+	}
+
+	size_t FlatAst::GetUsedBytes() const
+	{
+		return m_Nodes.size() * (sizeof(FlatNode) + sizeof(ValueType)) + m_Literals.size() * sizeof(u64) +
+		       (m_Children.size() + m_Statements.size()) * sizeof(NodeIndex);
+	}
+
+	NodeIndex FlatAst::LowerNode(const Statement* statement, LowerState& state)
+	{
+		// Expressions keep the type Sema inferred. Equal expressions that share a node have equal types.
+		if (IsExpression(statement->GetKind()))
+		{
+			const NodeIndex index = LowerExpression(static_cast<const Expression*>(statement), state);
+			m_Types[index]        = static_cast<const Expression*>(statement)->GetType();
+
+			return index;
+		}
+
+		const SourceLocation& location = statement->GetLocation();
+
+		switch (statement->GetKind())
+		{
+		case NodeKind::IfStatement:
+		{
+			const NodeIndex elseScope = PopLowered(state);
+			const NodeIndex thenScope = PopLowered(state);
+			const NodeIndex condition = PopLowered(state);
+
+			return AddNode(NodeKind::IfStatement, location, {condition, thenScope, elseScope});
+		}
+		case NodeKind::ReturnStatement:
+			return AddNode(NodeKind::ReturnStatement, location, {PopLowered(state)});
+		case NodeKind::VariableDeclaration:
+		{
+			const auto* declaration = static_cast<const VariableDeclaration*>(statement);
+
+			const VariableID variable = declaration->GetVariable();
+
+			if (variable != InvalidVariableID)
+				m_VariableCount = std::max(m_VariableCount, variable + 1);
+
+			return AddNode(NodeKind::VariableDeclaration, location,
+			               {PopLowered(state), variable, declaration->GetName()});
+		}
+		default:
+			break;
+		}
+
+		ASSERT(false, "Unexpected node kind {} in statement position.", static_cast<u32>(statement->GetKind()));
+
+		return InvalidNodeIndex;
+	}
+
+	NodeIndex FlatAst::LowerExpression(const Expression* expression, LowerState& state)
+	{
+		const SourceLocation& location = expression->GetLocation();
+
+		switch (expression->GetKind())
+		{
+		case NodeKind::NumberLiteral:
+			return AddLiteral(state, location, static_cast<const NumberLiteral*>(expression)->GetValue());
+		case NodeKind::BinaryExpression:
+		{
+			const NodeIndex right = PopLowered(state);
+			const NodeIndex left  = PopLowered(state);
+
+			// The facts are operands too, only expressions Sema proved the same about are shared.
+			return AddExpression(state, NodeKind::BinaryExpression, location, {left, right, expression->GetFacts()},
+			                     static_cast<const BinaryExpression*>(expression)->GetOperator());
+		}
+		case NodeKind::UnaryExpression:
+			return AddExpression(state, NodeKind::UnaryExpression, location,
+			                     {PopLowered(state), 0, expression->GetFacts()},
+			                     static_cast<const UnaryExpression*>(expression)->GetOperator());
+		case NodeKind::PowerExpression:
+		{
+			const NodeIndex exponent = PopLowered(state);
+			const NodeIndex base     = PopLowered(state);
+
+			return AddExpression(state, NodeKind::PowerExpression, location, {base, exponent, expression->GetFacts()});
+		}
+		case NodeKind::GroupingExpression:
+			return AddExpression(state, NodeKind::GroupingExpression, location, {PopLowered(state)});
+		case NodeKind::VariableExpression:
+		{
+			// Variables are never assigned after their declaration, reads of the same one are equal.
+			const auto* variable = static_cast<const VariableExpression*>(expression);
+
+			return AddExpression(state, NodeKind::VariableExpression, location,
+			                     {variable->GetVariable(), variable->GetName()});
+		}
+		case NodeKind::CallExpression:
+		{
+			// Calls have side effects, every call gets a node of its own.
+			const auto* call = static_cast<const CallExpression*>(expression);
+
+			const u32 count = static_cast<u32>(call->GetArgs().size());
+			const u32 first = AddChildren(state, count);
+
+			return AddNode(NodeKind::CallExpression, location, {call->GetCallee(), first, count});
+		}
+		default:
+			break;
+		}
+
+		ASSERT(false, "Unexpected expression kind {}.", static_cast<u32>(expression->GetKind()));
+
+		return InvalidNodeIndex;
+	}
+
+	NodeIndex FlatAst::PopLowered(LowerState& state)
+	{
+		const NodeIndex index = state.Lowered.back();
+		state.Lowered.pop_back();
+
+		return index;
+	}
+
+	NodeIndex FlatAst::LowerScope(const Scope* scope, LowerState& state)
+	{
+		const u32 count = static_cast<u32>(scope->GetStatements().size());
+		const u32 first = AddChildren(state, count);
+
+		return AddNode(NodeKind::Scope, scope->GetLocation(), {first, count});
+	}
+
+	NodeIndex FlatAst::AddNode(NodeKind kind, const SourceLocation& location, std::array<u32, 3> operands,
+	                           TokenType op)
+	{
+		ASSERT(m_Nodes.size() < InvalidNodeIndex, "Too many AST nodes.");
+
+		m_Nodes.push_back(FlatNode{kind, op, location.FileID, location.Offset, operands});
+		m_Types.push_back(ValueType::None);
+
+		return static_cast<NodeIndex>(m_Nodes.size() - 1);
+	}
+
+	u32 FlatAst::AddChildren(LowerState& state, size_t count)
+	{
+		const u32 first = static_cast<u32>(m_Children.size());
+
+		m_Children.insert(m_Children.end(), state.Lowered.end() - count, state.Lowered.end());
+		state.Lowered.resize(state.Lowered.size() - count);
+
+		return first;
+	}
+
+	NodeIndex FlatAst::AddExpression(LowerState& state, NodeKind kind, const SourceLocation& location,
+	                                 std::array<u32, 3> operands, TokenType op)
+	{
+		const FlatNode node = {kind, op, location.FileID, location.Offset, operands};
+
+		// Only expressions made of shareable expressions are shareable themselves, a call below keeps them apart.
+		bool isShareable = state.ShareExpressions;
+
+		ForEachChild(node, [&](NodeIndex child, u32) {
+			isShareable = isShareable && child < state.IsShareable.size() && state.IsShareable[child];
+		});
+
+		if (!isShareable)
+			return AddNode(kind, location, operands, op);
+
+		const u32 hash = HashNode(node, 0);
+
+		LowerState::SharedSlot& slot = FindSharedSlot(state, node, 0, hash);
+
+		if (slot.Node != InvalidNodeIndex)
+			return slot.Node;
+
+		slot = {hash, AddNode(kind, location, operands, op)};
+
+		return AddSharedNode(state, slot.Node);
+	}
+
+	NodeIndex FlatAst::AddLiteral(LowerState& state, const SourceLocation& location, u64 value)
+	{
+		const auto addLiteral = [&]() {
+			const u32 literal = static_cast<u32>(m_Literals.size());
+			m_Literals.push_back(value);
+
+			return AddNode(NodeKind::NumberLiteral, location, {literal});
+		};
+
+		if (!state.ShareExpressions)
+			return addLiteral();
+
+		// Literals are equal by value, not by their index in the literal table.
+		const FlatNode node = {NodeKind::NumberLiteral, TokenType::END_OF_FILE, location.FileID, location.Offset, {}};
+		const u32 hash      = HashNode(node, value);
+
+		LowerState::SharedSlot& slot = FindSharedSlot(state, node, value, hash);
+
+		if (slot.Node != InvalidNodeIndex)
+			return slot.Node;
+
+		slot = {hash, addLiteral()};
+
+		return AddSharedNode(state, slot.Node);
+	}
+
+	NodeIndex FlatAst::AddSharedNode(LowerState& state, NodeIndex index) const
+	{
+		state.IsShareable.resize(m_Nodes.size(), false);
+		state.IsShareable[index] = true;
+
+		if (++state.SharedCount * 2 > state.SharedSlots.size())
+			GrowSharedSlots(state);
+
+		return index;
+	}
+
+	FlatAst::LowerState::SharedSlot& FlatAst::FindSharedSlot(LowerState& state, const FlatNode& node, u64 literal,
+	                                                         u32 hash) const
+	{
+		const u32 mask = static_cast<u32>(state.SharedSlots.size()) - 1;
+
+		u32 index = hash & mask;
+
+		while (state.SharedSlots[index].Node != InvalidNodeIndex)
+		{
+			const LowerState::SharedSlot& slot = state.SharedSlots[index];
+			const FlatNode& other              = m_Nodes[slot.Node];
+
+			if (slot.Hash == hash && other.Kind == node.Kind && other.Operator == node.Operator)
+			{
+				const bool isEqual = node.Kind == NodeKind::NumberLiteral ? GetLiteral(other) == literal
+				                                                          : other.Operands == node.Operands;
+
+				if (isEqual)
+					break;
+			}
+
+			index = (index + 1) & mask;
+		}
+
+		return state.SharedSlots[index];
+	}
+
+	void FlatAst::GrowSharedSlots(LowerState& state) const
+	{
+		std::vector<LowerState::SharedSlot> slots(state.SharedSlots.size() * 2);
+		const u32 mask = static_cast<u32>(slots.size()) - 1;
+
+		for (const LowerState::SharedSlot& slot : state.SharedSlots)
+		{
+			if (slot.Node == InvalidNodeIndex)
+				continue;
+
+			u32 index = slot.Hash & mask;
+
+			while (slots[index].Node != InvalidNodeIndex) index = (index + 1) & mask;
+
+			slots[index] = slot;
+		}
+
+		state.SharedSlots = std::move(slots);
+	}
+
+	void FlatAst::Serialize(std::string& out) const
+	{
+		// Give every callee and variable name an index in the symbol list, in the order of first use.
+		std::unordered_map<SymbolID, u32> symbolIndices;
+		std::vector<std::string_view> symbols;
+
+		std::vector<FlatNode> nodes = m_Nodes;
+
+		for (FlatNode& node : nodes)
+		{
+			// The file is given when reading the data back.
+			node.FileID = 0;
+
+			const i32 symbolOperand = GetSymbolOperand(node.Kind);
+
+			if (symbolOperand < 0)
+				continue;
+
+			u32& symbol = node.Operands[symbolOperand];
+
+			const auto [it, isNew] = symbolIndices.try_emplace(symbol, static_cast<u32>(symbols.size()));
+
+			if (isNew)
+				symbols.push_back(StringInterner::Get().GetString(symbol));
+
+			symbol = it->second;
+		}
+
+		std::vector<u32> symbolLengths;
+		symbolLengths.reserve(symbols.size());
+
+		u32 symbolBytes = 0;
+
+		for (std::string_view symbol : symbols)
+		{
+			symbolLengths.push_back(static_cast<u32>(symbol.size()));
+			symbolBytes += static_cast<u32>(symbol.size());
+		}
+
+		const SerializedHeader header = {
+		    .Magic          = SerializedMagic,
+		    .Version        = SerializedVersion,
+		    .VariableCount  = m_VariableCount,
+		    .LiteralCount   = static_cast<u32>(m_Literals.size()),
+		    .SymbolCount    = static_cast<u32>(symbols.size()),
+		    .SymbolBytes    = symbolBytes,
+		    .ChildCount     = static_cast<u32>(m_Children.size()),
+		    .NodeCount      = static_cast<u32>(nodes.size()),
+		    .StatementCount = static_cast<u32>(m_Statements.size()),
+		};
+
+		out.reserve(out.size() + sizeof(header) + GetUsedBytes() + symbolLengths.size() * sizeof(u32) + symbolBytes);
+
+		Append(out, &header, 1);
+		Append(out, m_Literals.data(), m_Literals.size());
+		Append(out, symbolLengths.data(), symbolLengths.size());
+
+		for (std::string_view symbol : symbols) out.append(symbol);
+
+		Append(out, m_Children.data(), m_Children.size());
+		Append(out, nodes.data(), nodes.size());
+		Append(out, m_Types.data(), m_Types.size());
+		Append(out, m_Statements.data(), m_Statements.size());
+	}
+
+	u32 FlatAst::GetSerializedVersion()
+	{
+		return SerializedVersion;
+	}
+
+	std::optional<FlatAst> FlatAst::Deserialize(std::string_view data, u16 fileID)
+	{
+		Reader reader(data);
+
+		SerializedHeader header;
+
+		if (reader.GetRemaining() < sizeof(header))
+			return std::nullopt;
+
+		reader.Read(&header, 1);
+
+		if (header.Magic != SerializedMagic || header.Version != SerializedVersion)
+			return std::nullopt;
+
+		// Check the size before allocating anything, a truncated or corrupted file must not reserve gigabytes.
+		const u64 expectedSize = u64(header.LiteralCount) * sizeof(u64) + u64(header.SymbolCount) * sizeof(u32) +
+		                         header.SymbolBytes + u64(header.ChildCount) * sizeof(NodeIndex) +
+		                         u64(header.NodeCount) * (sizeof(FlatNode) + sizeof(ValueType)) +
+		                         u64(header.StatementCount) * sizeof(NodeIndex);
+
+		if (reader.GetRemaining() != expectedSize)
+			return std::nullopt;
+
+		FlatAst ast;
+
+		ast.m_VariableCount = header.VariableCount;
+
+		ast.m_Literals.resize(header.LiteralCount);
+		reader.Read(ast.m_Literals.data(), ast.m_Literals.size());
+
+		// Intern the names, nodes are mapped from the symbol list to the ids of this run.
+		std::vector<u32> symbolLengths(header.SymbolCount);
+		reader.Read(symbolLengths.data(), symbolLengths.size());
+
+		std::vector<SymbolID> symbols;
+		symbols.reserve(header.SymbolCount);
+
+		u64 symbolBytes = 0;
+
+		for (u32 length : symbolLengths) symbolBytes += length;
+
+		if (symbolBytes != header.SymbolBytes)
+			return std::nullopt;
+
+		for (u32 length : symbolLengths)
+		{
+			const std::string_view name = reader.ReadString(length);
+
+			if (!IsIdentifierName(name))
+				return std::nullopt;
+
+			symbols.push_back(StringInterner::Get().Intern(name));
+		}
+
+		ast.m_Children.resize(header.ChildCount);
+		reader.Read(ast.m_Children.data(), ast.m_Children.size());
+
+		ast.m_Nodes.resize(header.NodeCount);
+		reader.Read(ast.m_Nodes.data(), ast.m_Nodes.size());
+
+		ast.m_Types.resize(header.NodeCount);
+		reader.Read(ast.m_Types.data(), ast.m_Types.size());
+
+		// Lowering counts the variables up to the last declared one, a larger count would only size the tables.
+		u32 variableCount = 0;
+
+		for (NodeIndex index = 0; index < ast.m_Nodes.size(); index++)
+		{
+			FlatNode& node = ast.m_Nodes[index];
+
+			if (!ast.IsWellFormed(node, index, header.SymbolCount))
+				return std::nullopt;
+
+			if (node.Kind == NodeKind::VariableDeclaration)
+				variableCount = std::max(variableCount, node.Operands[1] + 1);
+
+			node.FileID = fileID;
+
+			if (const i32 symbolOperand = GetSymbolOperand(node.Kind); symbolOperand >= 0)
+				node.Operands[symbolOperand] = symbols[node.Operands[symbolOperand]];
+		}
+
+		ast.m_Statements.resize(header.StatementCount);
+		reader.Read(ast.m_Statements.data(), ast.m_Statements.size());
+
+		for (NodeIndex statement : ast.m_Statements)
+		{
+			if (statement >= ast.m_Nodes.size() || !IsStatementKind(ast.m_Nodes[statement].Kind))
+				return std::nullopt;
+		}
+
+		if (variableCount != header.VariableCount || !ast.IsWellScoped())
+			return std::nullopt;
+
+		return ast;
+	}
+
+	bool FlatAst::IsWellFormed(const FlatNode& node, NodeIndex index, u32 symbolCount) const
+	{
+		// Nodes are stored children first, so referring only backwards also rules out cycles.
+		const auto isChild = [index](NodeIndex operand) { return operand < index; };
+
+		const auto isExpression = [&](NodeIndex operand) {
+			return isChild(operand) && IsExpression(m_Nodes[operand].Kind);
+		};
+
+		const auto isStatement = [&](NodeIndex operand) {
+			return isChild(operand) && IsStatementKind(m_Nodes[operand].Kind);
+		};
+
+		const auto isScope = [&](NodeIndex operand) {
+			return isChild(operand) && m_Nodes[operand].Kind == NodeKind::Scope;
+		};
+
+		const auto isChildList = [&](u32 first, u32 count, auto&& isValidChild) {
+			if (u64(first) + count > m_Children.size())
+				return false;
+
+			const std::span<const NodeIndex> children = std::span<const NodeIndex>(m_Children).subspan(first, count);
+
+			return std::all_of(children.begin(), children.end(), isValidChild);
+		};
+
+		const std::array<u32, 3>& operands = node.Operands;
+		const ValueType type               = m_Types[index];
+
+		// Only binary and unary expressions carry an operator, the others keep the default of AddNode.
+		bool hasValidOperator = node.Operator == TokenType::END_OF_FILE;
+
+		if (node.Kind == NodeKind::BinaryExpression)
+			hasValidOperator = IsBinaryOperator(node.Operator);
+		else if (node.Kind == NodeKind::UnaryExpression)
+			hasValidOperator = node.Operator == TokenType::MINUS;
+
+		// Statements have no type, comparisons are Bool and groupings and variables take the type of what they
+		// stand for. Variables are matched with their declaration in IsWellScoped.
+		bool hasValidType = false;
+
+		if (!IsExpression(node.Kind))
+			hasValidType = type == ValueType::None;
+		else if (node.Kind == NodeKind::BinaryExpression && IsComparisonOperator(node.Operator))
+			hasValidType = type == ValueType::Bool;
+		else if (node.Kind == NodeKind::GroupingExpression)
+			hasValidType = isChild(operands[0]) && type == m_Types[operands[0]];
+		else if (node.Kind == NodeKind::VariableExpression)
+			hasValidType = type == ValueType::Bool || type == ValueType::Int32;
+		else
+			hasValidType = type == ValueType::Int32;
+
+		if (!hasValidOperator || !hasValidType)
+			return false;
+
+		switch (node.Kind)
+		{
+		case NodeKind::NumberLiteral:
+			return operands[0] < m_Literals.size();
+		case NodeKind::BinaryExpression:
+		case NodeKind::PowerExpression:
+			return isExpression(operands[0]) && isExpression(operands[1]) && operands[2] <= AllArithmeticFacts;
+		case NodeKind::UnaryExpression:
+			return isExpression(operands[0]) && operands[2] <= AllArithmeticFacts;
+		case NodeKind::GroupingExpression:
+		case NodeKind::ReturnStatement:
+			return isExpression(operands[0]);
+		case NodeKind::VariableExpression:
+			return operands[0] < m_VariableCount && operands[1] < symbolCount;
+		case NodeKind::CallExpression:
+			// Codegen only knows println, which takes one argument.
+			return operands[0] < symbolCount && operands[2] == 1 && isChildList(operands[1], operands[2], isExpression);
+		case NodeKind::VariableDeclaration:
+			return isExpression(operands[0]) && operands[1] < m_VariableCount && operands[2] < symbolCount;
+		case NodeKind::Scope:
+			return isChildList(operands[0], operands[1], isStatement);
+		case NodeKind::IfStatement:
+			return isExpression(operands[0]) && isScope(operands[1]) &&
+			       (operands[2] == InvalidNodeIndex || isScope(operands[2]));
+		default:
+			return false;
+		}
+	}
+
+	bool FlatAst::IsWellScoped() const
+	{
+		struct Visitor
+		{
+			const FlatAst& Ast;
+			std::vector<u8> IsDeclared;                    // By variable
+			std::vector<ValueType> VariableTypes;          // By variable, the type of the initializer
+			std::vector<VariableID> Declared;              // Variables in declaration order, scopes drop theirs
+			std::vector<u8> IsChecked;                     // By node, pure expressions checked in reach
+			std::vector<NodeIndex> Checked;                // Checked nodes in order, scopes forget theirs
+			std::vector<std::pair<size_t, size_t>> Scopes; // Sizes of Declared and Checked at scope entry
+			bool IsValid = true;
+
+			bool Enter(const WalkStep& step)
+			{
+				if (step.Node == InvalidNodeIndex)
+					return false;
+
+				const FlatNode& node = Ast.m_Nodes[step.Node];
+
+				if (node.Kind == NodeKind::Scope)
+					Scopes.emplace_back(Declared.size(), Checked.size());
+
+				if (node.Kind == NodeKind::VariableExpression)
+				{
+					const VariableID variable = node.Operands[0];
+
+					if (!IsDeclared[variable] || VariableTypes[variable] != Ast.m_Types[step.Node])
+						IsValid = false;
+				}
+
+				// Shared expressions are checked once in each scope, like Codegen generates them.
+				return IsValid && !IsChecked[step.Node];
+			}
+
+			void Leave(const WalkStep& step)
+			{
+				if (step.Node == InvalidNodeIndex)
+					return;
+
+				const FlatNode& node = Ast.m_Nodes[step.Node];
+
+				if (node.Kind == NodeKind::VariableDeclaration)
+				{
+					const VariableID variable = node.Operands[1];
+
+					if (IsDeclared[variable])
+						IsValid = false;
+
+					IsDeclared[variable]    = true;
+					VariableTypes[variable] = Ast.m_Types[node.Operands[0]];
+					Declared.push_back(variable);
+				}
+				else if (node.Kind == NodeKind::Scope)
+				{
+					const auto [declared, checked] = Scopes.back();
+					Scopes.pop_back();
+
+					for (size_t i = declared; i < Declared.size(); i++) IsDeclared[Declared[i]] = false;
+					for (size_t i = checked; i < Checked.size(); i++) IsChecked[Checked[i]] = false;
+
+					Declared.resize(declared);
+					Checked.resize(checked);
+				}
+				else if (IsPureExpression(node.Kind) && !IsChecked[step.Node])
+				{
+					IsChecked[step.Node] = true;
+					Checked.push_back(step.Node);
+				}
+			}
+		};
+
+		Visitor visitor = {*this,
+		                   std::vector<u8>(m_VariableCount),
+		                   std::vector<ValueType>(m_VariableCount),
+		                   {},
+		                   std::vector<u8>(m_Nodes.size()),
+		                   {},
+		                   {}};
+
+		Walk(m_Statements, visitor);
+
+		return visitor.IsValid;
+	}
+
+	i32 FlatAst::GetSymbolOperand(NodeKind kind)
+	{
+		switch (kind)
+		{
+		case NodeKind::CallExpression:
+			return 0;
+		case NodeKind::VariableExpression:
+			return 1;
+		case NodeKind::VariableDeclaration:
+			return 2;
+		default:
+			return -1;
+		}
+	}
+
+	void FlatAst::Dump() const
+	{
+		Walk(m_Statements, AstDumper(*this));
+	}
+} // namespace WandeltCore
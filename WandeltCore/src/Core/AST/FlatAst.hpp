@@ -0,0 +1,259 @@
+/**
+ * @file FlatAst.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+#include <algorithm>
+
+#include "Core/AST/AST.hpp"
+
+namespace WandeltCore
+{
+	using NodeIndex = u32;
+
+	constexpr NodeIndex InvalidNodeIndex = std::numeric_limits<NodeIndex>::max();
+
+	// A node of the FlatAst. Children are referred to by their index in the node array, literal values
+	// and child lists live in side tables. What the operands mean depends on the kind:
+	//
+	//   NumberLiteral       [literal index]
+	//   BinaryExpression    [left, right, arithmetic facts]                 Operator
+	//   UnaryExpression     [operand, unused, arithmetic facts]             Operator
+	//   PowerExpression     [base, exponent, arithmetic facts]
+	//   GroupingExpression  [expression]
+	//   VariableExpression  [variable, name symbol]
+	//   CallExpression      [callee symbol, first argument, argument count]
+	//   VariableDeclaration [initializer, variable, name symbol]
+	//   Scope               [first statement, statement count]
+	//   IfStatement         [condition, then scope, else scope or InvalidNodeIndex]
+	//   ReturnStatement     [expression]
+	//
+	// Function declarations only occur as callees, they are folded into the call as the symbol of the callee.
+	struct FlatNode
+	{
+		NodeKind Kind;
+		TokenType Operator;
+		u16 FileID;
+		u32 Offset;
+
+		std::array<u32, 3> Operands;
+
+		SourceLocation GetLocation() const { return {FileID, Offset}; }
+	};
+
+	static_assert(sizeof(FlatNode) == 20, "FlatNodes are packed into 20 bytes.");
+
+	// Where a walk over the FlatAst is. Missing children, like an if without else, are visited as InvalidNodeIndex.
+	struct WalkStep
+	{
+		NodeIndex Node;   // The visited node
+		NodeIndex Parent; // InvalidNodeIndex for the roots of the walk
+		u32 Slot;         // Position among the children of the parent, or among the roots
+		u32 Depth;        // 0 for the roots
+	};
+
+	// The AST as a contiguous node array. Nodes are stored children first, a node never refers to a node
+	// after it, so the array can be walked, copied and written out without chasing pointers.
+	class FlatAst
+	{
+	public:
+		FlatAst() = default;
+
+		// Lower the pointer tree the parser builds into a flat one. With shareExpressions, structurally equal
+		// expressions without side effects are lowered into one node that all their parents refer to, which
+		// turns the tree into a DAG. A shared node keeps the source location of its first occurrence.
+		static FlatAst Lower(std::span<Statement* const> statements, bool shareExpressions = false);
+
+		const FlatNode& GetNode(NodeIndex index) const { return m_Nodes[index]; }
+		u64 GetLiteral(const FlatNode& node) const { return m_Literals[node.Operands[0]]; }
+
+		// The type Sema inferred for an expression, None for statements.
+		ValueType GetType(NodeIndex index) const { return m_Types[index]; }
+
+		// Whether Sema proved the fact about a binary, unary or power expression.
+		static bool HasFact(const FlatNode& node, ArithmeticFact fact)
+		{
+			return node.Operands[2] & static_cast<ArithmeticFacts>(fact);
+		}
+
+		// The statements of a scope or the arguments of a call.
+		std::span<const NodeIndex> GetChildren(const FlatNode& node) const;
+
+		// The top level statements in source order.
+		std::span<const NodeIndex> GetStatements() const { return m_Statements; }
+
+		// Variables are numbered from 0 up to this, not all numbers have to be declared still.
+		u32 GetVariableCount() const { return m_VariableCount; }
+
+		size_t GetNodeCount() const { return m_Nodes.size(); }
+		size_t GetUsedBytes() const;
+
+		// Call function(child, slot) for the children of the node in source order. Operands that are no node,
+		// like the literal index or the callee symbol, are skipped.
+		template <typename Function>
+		void ForEachChild(const FlatNode& node, Function&& function) const;
+
+		// Walk the trees below the roots depth first, with an explicit stack instead of recursion so deep trees
+		// can not overflow the call stack. visitor.Enter(step) is called before the children of a node and
+		// returns whether to visit them, visitor.Leave(step) after them.
+		template <typename Visitor>
+		void Walk(std::span<const NodeIndex> roots, Visitor&& visitor) const;
+
+		void Dump() const;
+
+		// Append the AST in a compact binary form. Callees and variable names are written as strings, so the data
+		// does not depend on the interner of the compiler run that wrote it.
+		void Serialize(std::string& out) const;
+
+		// Read an AST written by Serialize in a single pass over the data, its nodes are placed in the given file.
+		// Returns nothing if the data is malformed or was written by another version of the format.
+		static std::optional<FlatAst> Deserialize(std::string_view data, u16 fileID);
+
+		// The version of the format Serialize writes.
+		static u32 GetSerializedVersion();
+
+	private:
+		// What lowering needs besides the AST being built.
+		struct LowerState
+		{
+			struct SharedSlot
+			{
+				u32 Hash       = 0;
+				NodeIndex Node = InvalidNodeIndex; // InvalidNodeIndex marks an empty slot
+			};
+
+			std::vector<NodeIndex> Lowered; // Indices of the lowered children their parent did not take yet
+
+			bool ShareExpressions = false;
+			std::vector<SharedSlot> SharedSlots; // Open-addressing table of the shared nodes, at most half full
+			u32 SharedCount = 0;                 // Nodes in the table
+			std::vector<bool> IsShareable;       // By node, pure expressions whose children are all shareable
+		};
+
+		// Lower one node whose children were lowered already, their indices are on top of the stack.
+		NodeIndex LowerNode(const Statement* statement, LowerState& state);
+		NodeIndex LowerExpression(const Expression* expression, LowerState& state);
+		NodeIndex LowerScope(const Scope* scope, LowerState& state);
+
+		// Take the last lowered child off the stack.
+		static NodeIndex PopLowered(LowerState& state);
+
+		// Move the last count lowered children into the side table, returns the index of the first.
+		u32 AddChildren(LowerState& state, size_t count);
+
+		NodeIndex AddNode(NodeKind kind, const SourceLocation& location, std::array<u32, 3> operands,
+		                  TokenType op = TokenType::END_OF_FILE);
+
+		// Add a node for a pure expression, or return the equal node added before when sharing expressions.
+		NodeIndex AddExpression(LowerState& state, NodeKind kind, const SourceLocation& location,
+		                        std::array<u32, 3> operands, TokenType op = TokenType::END_OF_FILE);
+		NodeIndex AddLiteral(LowerState& state, const SourceLocation& location, u64 value);
+
+		// Mark a node that was just put into the shared table as shareable.
+		NodeIndex AddSharedNode(LowerState& state, NodeIndex index) const;
+
+		// Find the shared node equal to the given one, or the empty slot to put it into.
+		LowerState::SharedSlot& FindSharedSlot(LowerState& state, const FlatNode& node, u64 literal, u32 hash) const;
+		void GrowSharedSlots(LowerState& state) const;
+
+		// Whether the operands of a deserialized node stay within the AST, only refer to nodes before it and are of
+		// the kinds the node expects, and whether its operator and type fit its kind.
+		bool IsWellFormed(const FlatNode& node, NodeIndex index, u32 symbolCount) const;
+
+		// Whether every variable is read after its declaration, inside the scope of it and with its type.
+		bool IsWellScoped() const;
+
+		// Which operand of the node holds a symbol, -1 for none.
+		static i32 GetSymbolOperand(NodeKind kind);
+
+	private:
+		std::vector<FlatNode> m_Nodes;
+		std::vector<ValueType> m_Types;      // By node, kept apart so FlatNodes stay packed
+		std::vector<u64> m_Literals;         // Values of the number literals
+		std::vector<NodeIndex> m_Children;   // Statements of scopes and arguments of calls
+		std::vector<NodeIndex> m_Statements; // The top level statements
+		u32 m_VariableCount = 0;             // One past the highest variable declared
+	};
+
+	template <typename Function>
+	void FlatAst::ForEachChild(const FlatNode& node, Function&& function) const
+	{
+		switch (node.Kind)
+		{
+		case NodeKind::BinaryExpression:
+		case NodeKind::PowerExpression:
+			function(node.Operands[0], 0);
+			function(node.Operands[1], 1);
+			break;
+		case NodeKind::UnaryExpression:
+		case NodeKind::GroupingExpression:
+		case NodeKind::ReturnStatement:
+		case NodeKind::VariableDeclaration:
+			function(node.Operands[0], 0);
+			break;
+		case NodeKind::CallExpression:
+		case NodeKind::Scope:
+		{
+			u32 slot = 0;
+
+			for (NodeIndex child : GetChildren(node)) function(child, slot++);
+			break;
+		}
+		case NodeKind::IfStatement:
+			function(node.Operands[0], 0);
+			function(node.Operands[1], 1);
+			function(node.Operands[2], 2);
+			break;
+		default:
+			break;
+		}
+	}
+
+	template <typename Visitor>
+	void FlatAst::Walk(std::span<const NodeIndex> roots, Visitor&& visitor) const
+	{
+		struct Entry
+		{
+			WalkStep Step;
+			bool IsEntered; // Whether the children were pushed already
+		};
+
+		std::vector<Entry> stack;
+		stack.reserve(roots.size() + 64);
+
+		// Pushed in reverse, so the nodes come off the stack in source order.
+		for (size_t i = roots.size(); i-- > 0;)
+			stack.push_back({{roots[i], InvalidNodeIndex, static_cast<u32>(i), 0}, false});
+
+		while (!stack.empty())
+		{
+			const WalkStep step = stack.back().Step;
+
+			if (stack.back().IsEntered)
+			{
+				stack.pop_back();
+				visitor.Leave(step);
+
+				continue;
+			}
+
+			stack.back().IsEntered = true;
+
+			if (!visitor.Enter(step) || step.Node == InvalidNodeIndex)
+				continue;
+
+			const size_t first = stack.size();
+
+			ForEachChild(m_Nodes[step.Node], [&](NodeIndex child, u32 slot) {
+				stack.push_back({{child, step.Node, slot, step.Depth + 1}, false});
+			});
+
+			std::reverse(stack.begin() + first, stack.end());
+		}
+	}
+} // namespace WandeltCore
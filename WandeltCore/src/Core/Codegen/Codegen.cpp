@@ -1,5 +1,6 @@
 #include "Codegen.hpp"
 
+#include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/raw_ostream.h>
@@ -17,17 +18,26 @@ namespace WandeltCore
 	{
 	}
 
-	void Codegen::GenerateIR(const std::vector<Statement*>& statements)
+	void Codegen::GenerateIR(const FlatAst& ast, bool checkArithmetic)
 	{
+		m_Ast             = &ast;
+		m_CheckArithmetic = checkArithmetic;
+		m_TrapBlock       = nullptr;
+
+		m_NodeValues.assign(ast.GetNodeCount(), nullptr);
+		m_GeneratedNodes.clear();
+
+		m_VariableValues.assign(ast.GetVariableCount(), nullptr);
+
 		GenerateEntrypoint();
 
-		for (Statement* statement : statements) GenerateStatement(statement);
+		const std::span<const NodeIndex> statements = ast.GetStatements();
+
+		ast.Walk(statements, *this);
 
 		// always return something
-		if (statements.empty() || !dynamic_cast<ReturnStatement*>(statements.back()))
-		{
-			GenerateStatement(new ReturnStatement(SourceLocation{}, new NumberLiteral(SourceLocation{}, 0)));
-		}
+		if (statements.empty() || ast.GetNode(statements.back()).Kind != NodeKind::ReturnStatement)
+			m_Builder.CreateRet(llvm::ConstantInt::get(m_Builder.getInt32Ty(), 0));
 
 		std::error_code ec;
 		llvm::raw_fd_ostream file("output.ll", ec, llvm::sys::fs::OF_Text);
@@ -70,103 +80,233 @@ namespace WandeltCore
 		llvm::Function* printf = llvm::Function::Create(type, llvm::Function::ExternalLinkage, "printf", m_Module);
 	}
 
-	llvm::Value* Codegen::GenerateStatement(Statement* statement)
+	bool Codegen::Enter(const WalkStep& step)
 	{
-		llvm::Value* result = statement->Generate(this);
+		if (step.Node == InvalidNodeIndex)
+			return false;
 
-		if (result)
-			return result;
+		// The condition of an if is done once the walk gets to its scopes.
+		if (step.Parent != InvalidNodeIndex && m_Ast->GetNode(step.Parent).Kind == NodeKind::IfStatement)
+		{
+			if (step.Slot == 1)
+				BeginIfStatement(m_Ast->GetNode(step.Parent), PopValue());
+			else if (step.Slot == 2)
+				BeginElseScope();
+		}
 
-		return nullptr;
+		// A shared expression that was generated already is not walked again.
+		return !m_NodeValues[step.Node];
+	}
+
+	void Codegen::Leave(const WalkStep& step)
+	{
+		if (step.Node == InvalidNodeIndex)
+			return;
+
+		const FlatNode& node = m_Ast->GetNode(step.Node);
+
+		if (llvm::Value* value = m_NodeValues[step.Node])
+		{
+			m_Values.push_back(value);
+		}
+		else
+		{
+			GenerateNode(node);
+
+			if (IsPureExpression(node.Kind))
+			{
+				m_NodeValues[step.Node] = m_Values.back();
+				m_GeneratedNodes.push_back(step.Node);
+			}
+		}
+
+		// Expressions used as statements are evaluated for their side effects only.
+		const bool isStatement =
+		    step.Parent == InvalidNodeIndex || m_Ast->GetNode(step.Parent).Kind == NodeKind::Scope;
+
+		if (isStatement && IsExpression(node.Kind))
+			PopValue();
+	}
+
+	void Codegen::GenerateNode(const FlatNode& node)
+	{
+		switch (node.Kind)
+		{
+		case NodeKind::NumberLiteral:
+			m_Values.push_back(GenerateNumberLiteral(node));
+			break;
+		case NodeKind::BinaryExpression:
+		{
+			llvm::Value* rhs = PopValue();
+			llvm::Value* lhs = PopValue();
+
+			m_Values.push_back(GenerateBinaryExpression(node, lhs, rhs));
+			break;
+		}
+		case NodeKind::UnaryExpression:
+			m_Values.push_back(GenerateUnaryExpression(node, AsInt32(PopValue(), node.Operands[0])));
+			break;
+		case NodeKind::PowerExpression:
+		{
+			llvm::Value* exponent = AsInt32(PopValue(), node.Operands[1]);
+			llvm::Value* base     = AsInt32(PopValue(), node.Operands[0]);
+
+			m_Values.push_back(GeneratePowerExpression(node, base, exponent));
+			break;
+		}
+		case NodeKind::GroupingExpression:
+			// The value of the inner expression stays on the stack.
+			break;
+		case NodeKind::VariableExpression:
+			m_Values.push_back(GenerateVariableExpression(node));
+			break;
+		case NodeKind::CallExpression:
+		{
+			const std::span<const NodeIndex> children = m_Ast->GetChildren(node);
+
+			const size_t argCount = children.size();
+			const std::span<llvm::Value*> args(m_Values.data() + m_Values.size() - argCount, argCount);
+
+			// Arguments are passed as i32.
+			for (size_t i = 0; i < argCount; i++) args[i] = AsInt32(args[i], children[i]);
+
+			llvm::Value* call = GenerateCallExpression(node, args);
+
+			m_Values.resize(m_Values.size() - argCount);
+			m_Values.push_back(call);
+			break;
+		}
+		case NodeKind::Scope:
+			break;
+		case NodeKind::IfStatement:
+			EndIfStatement();
+			break;
+		case NodeKind::ReturnStatement:
+			GenerateReturnStatement(AsInt32(PopValue(), node.Operands[0]));
+			break;
+		case NodeKind::VariableDeclaration:
+			GenerateVariableDeclaration(node, PopValue());
+			break;
+		default:
+			llvm_unreachable("unexpected node kind");
+		}
 	}
 
-	llvm::Value* Codegen::GenerateNumberLiteral(NumberLiteral* numberLiteral)
+	llvm::Value* Codegen::PopValue()
 	{
-		return llvm::ConstantInt::get(m_Builder.getInt32Ty(), numberLiteral->GetValue());
+		ASSERT(!m_Values.empty(), "No value for the expression.");
+
+		llvm::Value* value = m_Values.back();
+		m_Values.pop_back();
+
+		return value;
+	}
+
+	llvm::Value* Codegen::AsInt32(llvm::Value* value, NodeIndex expression)
+	{
+		return m_Ast->GetType(expression) == ValueType::Bool ? BoolToInt(value) : value;
 	}
 
-	llvm::Value* Codegen::GenerateBinaryExpression(BinaryExpression* binaryExpression)
+	llvm::Value* Codegen::AsBool(llvm::Value* value, NodeIndex expression)
 	{
-		llvm::Value* lhs = GenerateStatement(binaryExpression->GetLeft());
-		llvm::Value* rhs = GenerateStatement(binaryExpression->GetRight());
+		return m_Ast->GetType(expression) == ValueType::Bool ? value : IntToBool(value);
+	}
+
+	void Codegen::ForgetGeneratedSince(size_t first)
+	{
+		for (size_t i = first; i < m_GeneratedNodes.size(); i++) m_NodeValues[m_GeneratedNodes[i]] = nullptr;
 
-		TokenType op = binaryExpression->GetOperator();
+		m_GeneratedNodes.resize(first);
+	}
+
+	llvm::Value* Codegen::GenerateNumberLiteral(const FlatNode& numberLiteral)
+	{
+		// Values are i32 for now, wider literals wrap around.
+		return llvm::ConstantInt::get(m_Builder.getInt32Ty(), static_cast<u32>(m_Ast->GetLiteral(numberLiteral)));
+	}
+
+	llvm::Value* Codegen::GenerateBinaryExpression(const FlatNode& binaryExpression, llvm::Value* lhs, llvm::Value* rhs)
+	{
+		TokenType op = binaryExpression.Operator;
+
+		const NodeIndex left  = binaryExpression.Operands[0];
+		const NodeIndex right = binaryExpression.Operands[1];
+
+		// Two Bools are equal or not as they are, everything else works on the i32 0 or 1 of a Bool.
+		const bool isBoolEquality = (op == TokenType::EQUAL_EQUAL || op == TokenType::BANG_EQUAL) &&
+		                            m_Ast->GetType(left) == ValueType::Bool && m_Ast->GetType(right) == ValueType::Bool;
+
+		if (!isBoolEquality)
+		{
+			lhs = AsInt32(lhs, left);
+			rhs = AsInt32(rhs, right);
+		}
+
+		// Sema proved these, checked arithmetic only checks for the wraps it could not rule out.
+		const bool isNoSignedWrap   = FlatAst::HasFact(binaryExpression, ArithmeticFact::NoSignedWrap);
+		const bool isNoUnsignedWrap = FlatAst::HasFact(binaryExpression, ArithmeticFact::NoUnsignedWrap);
+		const bool isChecked        = m_CheckArithmetic && !isNoSignedWrap;
 
 		if (op == TokenType::PLUS)
-			return m_Builder.CreateAdd(lhs, rhs);
+			return isChecked ? GenerateCheckedArithmetic(llvm::Intrinsic::sadd_with_overflow, lhs, rhs)
+			                 : m_Builder.CreateAdd(lhs, rhs, "", isNoUnsignedWrap, isNoSignedWrap);
 		else if (op == TokenType::MINUS)
-			return m_Builder.CreateSub(lhs, rhs);
+			return isChecked ? GenerateCheckedArithmetic(llvm::Intrinsic::ssub_with_overflow, lhs, rhs)
+			                 : m_Builder.CreateSub(lhs, rhs, "", isNoUnsignedWrap, isNoSignedWrap);
 		else if (op == TokenType::STAR)
-			return m_Builder.CreateMul(lhs, rhs);
-		else if (op == TokenType::SLASH)
-			return m_Builder.CreateSDiv(lhs, rhs);
-		else if (op == TokenType::PERCENT)
-			return m_Builder.CreateSRem(lhs, rhs);
+			return isChecked ? GenerateCheckedArithmetic(llvm::Intrinsic::smul_with_overflow, lhs, rhs)
+			                 : m_Builder.CreateMul(lhs, rhs, "", isNoUnsignedWrap, isNoSignedWrap);
+
+		if (op == TokenType::SLASH || op == TokenType::PERCENT)
+		{
+			if (m_CheckArithmetic)
+				GenerateDivisionChecks(binaryExpression, lhs, rhs);
 
-		lhs = IntToDouble(lhs);
-		rhs = IntToDouble(rhs);
+			return op == TokenType::SLASH ? m_Builder.CreateSDiv(lhs, rhs) : m_Builder.CreateSRem(lhs, rhs);
+		}
 
+		// Comparisons are Bool, they stay i1 until a use needs an i32.
 		if (op == TokenType::EQUAL_EQUAL)
-			return BoolToInt(m_Builder.CreateFCmpOEQ(lhs, rhs));
+			return m_Builder.CreateICmpEQ(lhs, rhs);
 		else if (op == TokenType::BANG_EQUAL)
-			return BoolToInt(m_Builder.CreateFCmpONE(lhs, rhs));
+			return m_Builder.CreateICmpNE(lhs, rhs);
 		else if (op == TokenType::LESS)
-			return BoolToInt(m_Builder.CreateFCmpOLT(lhs, rhs));
+			return m_Builder.CreateICmpSLT(lhs, rhs);
 		else if (op == TokenType::LESS_EQUAL)
-			return BoolToInt(m_Builder.CreateFCmpOLE(lhs, rhs));
+			return m_Builder.CreateICmpSLE(lhs, rhs);
 		else if (op == TokenType::GREATER)
-			return BoolToInt(m_Builder.CreateFCmpOGT(lhs, rhs));
+			return m_Builder.CreateICmpSGT(lhs, rhs);
 		else if (op == TokenType::GREATER_EQUAL)
-			return BoolToInt(m_Builder.CreateFCmpOGE(lhs, rhs));
+			return m_Builder.CreateICmpSGE(lhs, rhs);
 
 		llvm_unreachable("unexpected binary operator");
 
 		return nullptr;
 	}
 
-	llvm::Value* Codegen::GenerateUnaryExpression(UnaryExpression* unaryExpression)
+	llvm::Value* Codegen::GenerateUnaryExpression(const FlatNode& unaryExpression, llvm::Value* operand)
 	{
-		llvm::Value* operand = GenerateStatement(unaryExpression->GetOperand());
-		const TokenType& op  = unaryExpression->GetOperator();
+		const TokenType& op = unaryExpression.Operator;
 
 		if (op == TokenType::MINUS)
-			return m_Builder.CreateNeg(operand);
+		{
+			const bool isNoSignedWrap = FlatAst::HasFact(unaryExpression, ArithmeticFact::NoSignedWrap);
+
+			if (m_CheckArithmetic && !isNoSignedWrap)
+				return GenerateCheckedArithmetic(llvm::Intrinsic::ssub_with_overflow, m_Builder.getInt32(0), operand);
+
+			return isNoSignedWrap ? m_Builder.CreateNSWNeg(operand) : m_Builder.CreateNeg(operand);
+		}
 
 		llvm_unreachable("unexpected unary operator");
 
 		return nullptr;
 	}
 
-	llvm::Value* Codegen::GeneratePowerExpression(PowerExpression* powerExpression)
+	llvm::Value* Codegen::GeneratePowerExpression(const FlatNode& powerExpression, llvm::Value* base,
+	                                              llvm::Value* exponent)
 	{
-		llvm::Value* base     = GenerateStatement(powerExpression->GetBase());
-		llvm::Value* exponent = GenerateStatement(powerExpression->GetExponent());
-
-		// if base and exponent are numbers, we can calculate the result at compile time
-		if (llvm::ConstantInt* baseConstant = llvm::dyn_cast<llvm::ConstantInt>(base))
-		{
-			if (llvm::ConstantInt* exponentConstant = llvm::dyn_cast<llvm::ConstantInt>(exponent))
-			{
-				llvm::APInt baseValue = baseConstant->getValue();
-				int64_t exponentValue = exponentConstant->getValue().getSExtValue();
-
-				llvm::APInt result = baseValue;
-				if (exponentValue == 0)
-				{
-					result = llvm::APInt(baseValue.getBitWidth(), 1); // base^0 = 1
-				}
-				else
-				{
-					for (int64_t i = 1; i < exponentValue; ++i)
-					{
-						result *= baseValue;
-					}
-				}
-
-				return llvm::ConstantInt::get(base->getType(), result);
-			}
-		}
-
+		// Constant powers are folded by Sema, what is left is computed at runtime.
 		llvm::Function* function = m_Builder.GetInsertBlock()->getParent();
 
 		llvm::BasicBlock* entryBlock     = m_Builder.GetInsertBlock();
@@ -193,8 +333,25 @@ namespace WandeltCore
 		llvm::PHINode* counterPhi = m_Builder.CreatePHI(exponent->getType(), 2, "counter");
 		counterPhi->addIncoming(counter, entryBlock);
 
-		// Multiply the result by the base
-		llvm::Value* newResult = m_Builder.CreateMul(resultPhi, base);
+		// Multiply the result by the base. The last iteration multiplies once more than the exponent says, that
+		// product is never used and may wrap around.
+		const bool isNoSignedWrap = FlatAst::HasFact(powerExpression, ArithmeticFact::NoSignedWrap);
+
+		llvm::Value* newResult = nullptr;
+		llvm::Value* overflow  = nullptr;
+
+		if (m_CheckArithmetic && !isNoSignedWrap)
+		{
+			llvm::Value* product =
+			    m_Builder.CreateBinaryIntrinsic(llvm::Intrinsic::smul_with_overflow, resultPhi, base);
+
+			newResult = m_Builder.CreateExtractValue(product, 0);
+			overflow  = m_Builder.CreateExtractValue(product, 1);
+		}
+		else
+		{
+			newResult = m_Builder.CreateMul(resultPhi, base, "", false, isNoSignedWrap);
+		}
 
 		// Increment the counter
 		llvm::Value* newCounter = m_Builder.CreateAdd(counterPhi, llvm::ConstantInt::get(exponent->getType(), 1));
@@ -202,9 +359,13 @@ namespace WandeltCore
 		// Check if the counter is less than or equal to the exponent
 		llvm::Value* condition = m_Builder.CreateICmpULE(newCounter, exponent);
 
-		// Add the new values to the PHI nodes
-		resultPhi->addIncoming(newResult, loopBlock);
-		counterPhi->addIncoming(newCounter, loopBlock);
+		// Only a product the next iteration uses has to fit.
+		if (overflow)
+			TrapIf(m_Builder.CreateAnd(overflow, condition));
+
+		// Add the new values to the PHI nodes, the check may have moved the end of the loop to a block of its own
+		resultPhi->addIncoming(newResult, m_Builder.GetInsertBlock());
+		counterPhi->addIncoming(newCounter, m_Builder.GetInsertBlock());
 
 		// Create the conditional branch
 		m_Builder.CreateCondBr(condition, loopBlock, afterLoopBlock);
@@ -216,77 +377,140 @@ namespace WandeltCore
 		return resultPhi;
 	}
 
-	llvm::Value* Codegen::GenerateGroupingExpression(GroupingExpression* groupingExpression)
+	llvm::Value* Codegen::GenerateVariableExpression(const FlatNode& variableExpression)
 	{
-		return GenerateStatement(groupingExpression->GetExpression());
+		llvm::Value* value = m_VariableValues[variableExpression.Operands[0]];
+
+		ASSERT(value, "Variable read before its declaration.");
+
+		return value;
 	}
 
-	llvm::Value* Codegen::GenerateCallExpression(CallExpression* callExpression)
+	llvm::Value* Codegen::GenerateCallExpression([[maybe_unused]] const FlatNode& callExpression,
+	                                             std::span<llvm::Value* const> args)
 	{
-		// llvm::Function* function = m_Module.getFunction(callExpression->GetDeclaration()->GetIdentifier());
+		// The callee is not looked up yet, every call is println.
+		// llvm::Function* function = m_Module.getFunction(StringInterner::Get().GetString(callExpression.Operands[0]));
 		llvm::Function* function = m_Module.getFunction("printf");
 
 		// for now only println(12) is supported
 
-		llvm::Value* arg = GenerateStatement(callExpression->GetArgs().front());
-
-		std::vector<llvm::Value*> args = {m_Builder.CreateGlobalStringPtr("%d\n"), arg};
+		std::vector<llvm::Value*> printfArgs = {m_Builder.CreateGlobalStringPtr("%d\n"), args.front()};
 
-		return m_Builder.CreateCall(function, args);
+		return m_Builder.CreateCall(function, printfArgs);
 	}
 
-	llvm::Value* Codegen::GenerateDeclaration(Declaration* declaration)
+	void Codegen::BeginIfStatement(const FlatNode& ifStatement, llvm::Value* condition)
 	{
-		return nullptr;
+		const bool hasElse = ifStatement.Operands[2] != InvalidNodeIndex;
+
+		llvm::BasicBlock* exitBlock  = llvm::BasicBlock::Create(m_Context, "if.exit");
+		llvm::BasicBlock* trueBlock  = llvm::BasicBlock::Create(m_Context, "if.true");
+		llvm::BasicBlock* falseBlock = hasElse ? llvm::BasicBlock::Create(m_Context, "if.else") : exitBlock;
+
+		// A Bool condition is branched on as it is.
+		m_Builder.CreateCondBr(AsBool(condition, ifStatement.Operands[0]), trueBlock, falseBlock);
+
+		trueBlock->insertInto(GetCurrentFunction());
+		m_Builder.SetInsertPoint(trueBlock);
+
+		m_PendingIfs.push_back({exitBlock, falseBlock, m_GeneratedNodes.size()});
 	}
 
-	llvm::Value* Codegen::GenerateIfStatement(IfStatement* ifStatement)
+	void Codegen::BeginElseScope()
 	{
-		llvm::Function* fn = GetCurrentFunction();
+		const PendingIf& pendingIf = m_PendingIfs.back();
 
-		const bool hasElse = ifStatement->HasElseScope();
+		// What the then scope generated does not dominate the else scope.
+		ForgetGeneratedSince(pendingIf.FirstGenerated);
 
-		llvm::Value* condition = GenerateStatement(ifStatement->GetCondition());
+		BranchUnlessTerminated(pendingIf.ExitBlock);
 
-		llvm::BasicBlock* exitBlock  = llvm::BasicBlock::Create(m_Context, "if.exit");
-		llvm::BasicBlock* trueBlock  = llvm::BasicBlock::Create(m_Context, "if.true");
-		llvm::BasicBlock* falseBlock = hasElse ? llvm::BasicBlock::Create(m_Context, "if.else") : exitBlock;
+		pendingIf.ElseBlock->insertInto(GetCurrentFunction());
+		m_Builder.SetInsertPoint(pendingIf.ElseBlock);
+	}
 
-		m_Builder.CreateCondBr(IntToBool(condition), trueBlock, falseBlock);
+	void Codegen::EndIfStatement()
+	{
+		llvm::BasicBlock* exitBlock = m_PendingIfs.back().ExitBlock;
 
-		trueBlock->insertInto(fn);
-		m_Builder.SetInsertPoint(trueBlock);
-		GenerateScope(ifStatement->GetThenScope());
-		m_Builder.CreateBr(exitBlock);
+		ForgetGeneratedSince(m_PendingIfs.back().FirstGenerated);
+		m_PendingIfs.pop_back();
 
-		if (hasElse)
-		{
-			falseBlock->insertInto(fn);
-			m_Builder.SetInsertPoint(falseBlock);
-			GenerateScope(ifStatement->GetElseScope());
-			m_Builder.CreateBr(exitBlock);
-		}
+		BranchUnlessTerminated(exitBlock);
 
-		exitBlock->insertInto(fn);
+		exitBlock->insertInto(GetCurrentFunction());
 		m_Builder.SetInsertPoint(exitBlock);
-
-		return nullptr;
 	}
 
-	llvm::Value* Codegen::GenerateReturnStatement(ReturnStatement* returnStatement)
+	void Codegen::BranchUnlessTerminated(llvm::BasicBlock* target)
 	{
-		llvm::Value* returnValue = GenerateStatement(returnStatement->GetExpression());
+		if (!m_Builder.GetInsertBlock()->getTerminator())
+			m_Builder.CreateBr(target);
+	}
 
+	void Codegen::GenerateReturnStatement(llvm::Value* returnValue)
+	{
 		m_Builder.CreateRet(returnValue);
+	}
 
-		return nullptr;
+	void Codegen::GenerateVariableDeclaration(const FlatNode& variableDeclaration, llvm::Value* initializer)
+	{
+		// Variables are never assigned again, the value of the initializer is the SSA value of the variable. The
+		// declaration dominates every read, Sema only resolves names to declarations in scopes around them.
+		m_VariableValues[variableDeclaration.Operands[1]] = initializer;
+
+		if (initializer->hasName() || !llvm::isa<llvm::Instruction>(initializer))
+			return;
+
+		// Name the value after the variable, without the '$'.
+		initializer->setName(StringInterner::Get().GetString(variableDeclaration.Operands[2]).substr(1));
 	}
 
-	llvm::Value* Codegen::GenerateScope(Scope* scope)
+	llvm::Value* Codegen::GenerateCheckedArithmetic(llvm::Intrinsic::ID intrinsic, llvm::Value* lhs, llvm::Value* rhs)
 	{
-		for (Statement* statement : scope->GetStatements()) GenerateStatement(statement);
+		llvm::Value* result = m_Builder.CreateBinaryIntrinsic(intrinsic, lhs, rhs);
 
-		return nullptr;
+		TrapIf(m_Builder.CreateExtractValue(result, 1));
+
+		return m_Builder.CreateExtractValue(result, 0);
+	}
+
+	void Codegen::GenerateDivisionChecks(const FlatNode& division, llvm::Value* lhs, llvm::Value* rhs)
+	{
+		if (!FlatAst::HasFact(division, ArithmeticFact::NonZeroDivisor))
+			TrapIf(m_Builder.CreateICmpEQ(rhs, m_Builder.getInt32(0)));
+
+		if (!FlatAst::HasFact(division, ArithmeticFact::NoDivisionOverflow))
+		{
+			llvm::Value* intMin   = m_Builder.getInt32(static_cast<u32>(std::numeric_limits<i32>::min()));
+			llvm::Value* minusOne = m_Builder.getInt32(static_cast<u32>(-1));
+
+			llvm::Value* isMin      = m_Builder.CreateICmpEQ(lhs, intMin);
+			llvm::Value* isMinusOne = m_Builder.CreateICmpEQ(rhs, minusOne);
+
+			TrapIf(m_Builder.CreateAnd(isMin, isMinusOne));
+		}
+	}
+
+	void Codegen::TrapIf(llvm::Value* condition)
+	{
+		llvm::Function* function = GetCurrentFunction();
+
+		// All checks of the function branch to one block that traps.
+		if (!m_TrapBlock)
+		{
+			m_TrapBlock = llvm::BasicBlock::Create(m_Context, "trap", function);
+
+			llvm::IRBuilder<> builder(m_TrapBlock);
+			builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+			builder.CreateUnreachable();
+		}
+
+		llvm::BasicBlock* checkedBlock = llvm::BasicBlock::Create(m_Context, "checked", function);
+
+		m_Builder.CreateCondBr(condition, m_TrapBlock, checkedBlock);
+		m_Builder.SetInsertPoint(checkedBlock);
 	}
 
 	llvm::Function* Codegen::GetCurrentFunction()
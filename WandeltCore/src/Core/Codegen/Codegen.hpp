@@ -29,17 +29,19 @@
 // #include <llvm/Transforms/Scalar/Reassociate.h>
 // #include <llvm/Transforms/Scalar/SimplifyCFG.h>
 
-#include "Core/AST/AST.hpp"
+#include "Core/AST/FlatAst.hpp"
 
 namespace WandeltCore
 {
-	class Codegen : public Visitor
+	class Codegen
 	{
 	public:
 		Codegen();
 		~Codegen();
 
-		void GenerateIR(const std::vector<Statement*>& statements);
+		// With checkArithmetic, arithmetic Sema could not prove safe traps at runtime instead of wrapping around
+		// or dividing by 0.
+		void GenerateIR(const FlatAst& ast, bool checkArithmetic = false);
 
 		const llvm::Module& GetModuleWithGeneratedIR() const { return m_Module; }
 
@@ -49,21 +51,49 @@ namespace WandeltCore
 		void GenerateBuiltins();
 		void GenerateBuiltinPrintlnFunction();
 
-		llvm::Value* GenerateStatement(Statement* statement);
+		// Called by the walk over the AST. Expressions are generated when they are left, their operands are on the
+		// value stack then. If statements are generated piecewise as the walk enters their scopes.
+		bool Enter(const WalkStep& step);
+		void Leave(const WalkStep& step);
 
-		llvm::Value* GenerateNumberLiteral(NumberLiteral* numberLiteral) override;
-		llvm::Value* GenerateBinaryExpression(BinaryExpression* binaryExpression) override;
-		llvm::Value* GenerateUnaryExpression(UnaryExpression* unaryExpression) override;
-		llvm::Value* GeneratePowerExpression(PowerExpression* powerExpression) override;
-		llvm::Value* GenerateGroupingExpression(GroupingExpression* groupingExpression) override;
+		// Generate the node, its operands are on the value stack.
+		void GenerateNode(const FlatNode& node);
 
-		llvm::Value* GenerateDeclaration(class Declaration* declaration) override;
-		llvm::Value* GenerateCallExpression(class CallExpression* callExpression) override;
+		llvm::Value* PopValue();
 
-		llvm::Value* GenerateIfStatement(IfStatement* ifStatement) override;
-		llvm::Value* GenerateReturnStatement(ReturnStatement* returnStatement) override;
+		// The value of the expression converted to the type, by the type Sema inferred for the expression.
+		llvm::Value* AsInt32(llvm::Value* value, NodeIndex expression);
+		llvm::Value* AsBool(llvm::Value* value, NodeIndex expression);
 
-		llvm::Value* GenerateScope(Scope* scope);
+		// Values of pure expressions generated in a block that no longer dominates the insert point can not be
+		// reused, drop them from the generated values.
+		void ForgetGeneratedSince(size_t first);
+
+		llvm::Value* GenerateNumberLiteral(const FlatNode& numberLiteral);
+		llvm::Value* GenerateBinaryExpression(const FlatNode& binaryExpression, llvm::Value* lhs, llvm::Value* rhs);
+		llvm::Value* GenerateUnaryExpression(const FlatNode& unaryExpression, llvm::Value* operand);
+		llvm::Value* GeneratePowerExpression(const FlatNode& powerExpression, llvm::Value* base, llvm::Value* exponent);
+		llvm::Value* GenerateVariableExpression(const FlatNode& variableExpression);
+
+		llvm::Value* GenerateCallExpression(const FlatNode& callExpression, std::span<llvm::Value* const> args);
+
+		// Branch on the condition and start the then scope.
+		void BeginIfStatement(const FlatNode& ifStatement, llvm::Value* condition);
+		void BeginElseScope();
+		void EndIfStatement();
+
+		// Branch to the target, unless the block ended in a return already.
+		void BranchUnlessTerminated(llvm::BasicBlock* target);
+
+		void GenerateReturnStatement(llvm::Value* returnValue);
+		void GenerateVariableDeclaration(const FlatNode& variableDeclaration, llvm::Value* initializer);
+
+		// Checked arithmetic. Generate the llvm.*.with.overflow intrinsic and trap if it overflows.
+		llvm::Value* GenerateCheckedArithmetic(llvm::Intrinsic::ID intrinsic, llvm::Value* lhs, llvm::Value* rhs);
+		void GenerateDivisionChecks(const FlatNode& division, llvm::Value* lhs, llvm::Value* rhs);
+
+		// Branch to the trap block if the condition holds, generation goes on in a new block behind the check.
+		void TrapIf(llvm::Value* condition);
 
 		llvm::Function* GetCurrentFunction();
 
@@ -80,5 +110,28 @@ namespace WandeltCore
 		llvm::LLVMContext m_Context;
 		llvm::IRBuilder<> m_Builder;
 		llvm::Module m_Module;
+
+		const FlatAst* m_Ast = nullptr; // The AST IR is generated for
+
+		bool m_CheckArithmetic        = false;   // Whether arithmetic Sema could not prove safe traps at runtime
+		llvm::BasicBlock* m_TrapBlock = nullptr; // The block all checks of the function branch to, once needed
+
+		struct PendingIf
+		{
+			llvm::BasicBlock* ExitBlock;
+			llvm::BasicBlock* ElseBlock; // The exit block if there is no else scope
+			size_t FirstGenerated;       // Size of m_GeneratedNodes when the then scope started
+		};
+
+		std::vector<llvm::Value*> m_Values;  // Values of the generated expressions their parent still needs
+		std::vector<PendingIf> m_PendingIfs; // The if statements the walk is inside of
+
+		// A node shared by several parents is generated once and its value reused while it dominates the uses.
+		std::vector<llvm::Value*> m_NodeValues;  // By node, the value of a pure expression generated before
+		std::vector<NodeIndex> m_GeneratedNodes; // The nodes with a value in m_NodeValues, in generation order
+
+		std::vector<llvm::Value*> m_VariableValues; // By variable, the value it was declared with
+
+		friend class FlatAst;
 	};
 } // namespace WandeltCore
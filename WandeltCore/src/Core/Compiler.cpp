@@ -2,7 +2,9 @@
 
 #include "Codegen/Codegen.hpp"
 #include "Lexer/Lexer.hpp"
+#include "ParseCache/ParseCache.hpp"
 #include "Parser/Parser.hpp"
+#include "Sema/Sema.hpp"
 #include "ScopedTimer.hpp"
 
 namespace WandeltCore
@@ -14,97 +16,173 @@ namespace WandeltCore
 	void Compiler::Compile()
 	{
 		Lexer lexer(m_Args.InputFile);
+		ParseCache cache(m_Args.CacheDirectory, m_Args.Flags & CompilerFlags::ShareExpressions);
 
+		std::optional<FlatAst> cachedAst;
+
+		// The token dump needs the tokens, so the cache is only used without it.
+		if (cache.IsEnabled() && !(m_Args.Flags & CompilerFlags::VerboseLexer))
 		{
-			ScopedTimer timer("Lexing took: {} ms, {} ns");
-			lexer.Lex();
+			ScopedTimer timer("Loading the cached AST took: {} ms, {} ns");
+			cachedAst = cache.Load(lexer.GetFileID());
 		}
 
-		const std::vector<Token>& tokens = lexer.GetTokens();
+		FlatAst flatAst;
 
-		if (m_Args.Flags & CompilerFlags::VerboseLexer)
+		if (cachedAst)
 		{
-			SYSTEM_DEBUG("Tokens: ");
+			flatAst = std::move(*cachedAst);
 
-			for (const Token& token : tokens)
+			if (m_Args.Flags & CompilerFlags::VerboseParser)
 			{
-				SYSTEM_DEBUG("Token [{}]: {} at line: {} column: {}", TokenTypeToString(token.Type),
-				             token.Lexeme.has_value() ? token.Lexeme.value()
-				                                      : TokenTypeToStringRepresentation(token.Type),
-				             token.Location.Line, token.Location.Column);
+				SYSTEM_DEBUG("Statements: ");
+
+				flatAst.Dump();
 			}
 		}
+		else
+		{
+			if (!LexAndParse(lexer, flatAst))
+				return;
 
-		if (!lexer.IsValid())
+			if (cache.IsEnabled())
+			{
+				ScopedTimer timer("Storing the AST in the cache took: {} ms, {} ns");
+				cache.Store(lexer.GetFileID(), flatAst);
+			}
+		}
+
+		Codegen codegen;
 		{
-			SYSTEM_ERROR("Lexing failed. Syntax errors occurred. Exiting.");
+			ScopedTimer timer("Generating IR took: {} ms, {} ns");
+			codegen.GenerateIR(flatAst, m_Args.Flags & CompilerFlags::CheckedArithmetic);
+		}
 
-			return;
+		if (m_Args.Flags & CompilerFlags::VerboseCodegen)
+		{
+			SYSTEM_DEBUG("Generated IR: ");
+
+			codegen.GetModuleWithGeneratedIR().print(llvm::outs(), nullptr);
 		}
 
-		Parser parser(tokens);
+		int ret = 0;
 
 		{
-			ScopedTimer timer("Parsing took: {} ms, {} ns");
-			parser.Parse();
+			ScopedTimer timer("Compiling took: {} ms, {} ns");
+
+			ret = std::system(
+			    std::vformat("clang output.ll -o {} -Wno-override-module", std::make_format_args(m_Args.OutputFile))
+			        .c_str());
 		}
 
-		std::vector<Statement*> statements = parser.GetStatements();
+		SYSTEM_INFO("Saved output to: {}", m_Args.OutputFile);
 
-		if (m_Args.Flags & CompilerFlags::VerboseParser)
+		if (ret != 0)
 		{
-			SYSTEM_DEBUG("Statements: ");
+			SYSTEM_ERROR("Failed to compile the generated IR. Exiting.");
 
-			for (Statement* statement : statements)
+			return;
+		}
+	}
+
+	bool Compiler::LexAndParse(Lexer& lexer, FlatAst& flatAst)
+	{
+		// The token dump needs all tokens up front, and large sources are faster to lex and parse up front in parallel.
+		// Otherwise the parser pulls tokens from the lexer on demand and only a handful is in memory at any time.
+		const bool isStreaming = !(m_Args.Flags & CompilerFlags::VerboseLexer) && !lexer.IsLexedInParallel();
+
+		lexer.SetErrorLimit(m_Args.ErrorLimit);
+
+		if (!isStreaming)
+		{
 			{
-				if (statement == nullptr)
+				ScopedTimer timer("Lexing took: {} ms, {} ns");
+				lexer.Lex();
+			}
+
+			if (m_Args.Flags & CompilerFlags::VerboseLexer)
+			{
+				SYSTEM_DEBUG("Tokens: ");
+
+				for (const Token& token : lexer.GetTokens())
 				{
-					SYSTEM_DEBUG("Statements is nullptr.");
+					const ResolvedLocation location = SourceManager::Resolve(token.GetLocation());
 
-					continue;
+					SYSTEM_DEBUG("Token [{}]: {} at line: {} column: {}", TokenTypeToString(token.Type),
+					             token.HasLexeme() ? token.GetLexeme() : TokenTypeToStringRepresentation(token.Type),
+					             location.Line, location.Column);
 				}
+			}
+
+			// The lexer skips what it could not lex, so parsing still reports the errors in the rest of the file.
+			// Unless the lexer stopped at the error limit, the tokens end early then.
+			if (lexer.HasReachedErrorLimit())
+			{
+				SYSTEM_ERROR("Lexing failed. Syntax errors occurred. Exiting.");
 
-				statement->Dump();
+				return false;
 			}
 		}
 
-		if (!parser.IsValid())
-		{
-			SYSTEM_ERROR("Parsing failed. Syntax errors occurred. Exiting.");
+		Parser parser(isStreaming ? TokenStream(lexer) : TokenStream(lexer.GetTokens()));
 
-			return;
-		}
+		// The errors of a streaming lexer are counted by the parser, those of tokens lexed up front are known now.
+		if (m_Args.ErrorLimit != 0)
+			parser.SetErrorLimit(m_Args.ErrorLimit - lexer.GetErrorCount());
 
-		Codegen codegen;
 		{
-			ScopedTimer timer("Generating IR took: {} ms, {} ns");
-			codegen.GenerateIR(statements);
+			ScopedTimer timer(isStreaming ? "Lexing and parsing took: {} ms, {} ns" : "Parsing took: {} ms, {} ns");
+			parser.Parse();
 		}
 
-		if (m_Args.Flags & CompilerFlags::VerboseCodegen)
+		if (!lexer.IsValid())
 		{
-			SYSTEM_DEBUG("Generated IR: ");
+			SYSTEM_ERROR("Lexing failed. Syntax errors occurred. Exiting.");
 
-			codegen.GetModuleWithGeneratedIR().print(llvm::outs(), nullptr);
+			return false;
 		}
 
-		int ret = 0;
+		bool isAnalyzed = false;
 
 		{
-			ScopedTimer timer("Compiling took: {} ms, {} ns");
+			// The AST moves on to the next phases, nothing of it is copied. The pointer tree is only needed
+			// until it is lowered, the later phases work on the flat one.
+			Ast ast = parser.TakeAst();
 
-			ret = std::system(
-			    std::vformat("clang output.ll -o {} -Wno-override-module", std::make_format_args(m_Args.OutputFile))
-			        .c_str());
+			// Semantic analysis only makes sense on an AST without syntax errors, it is dumped as parsed otherwise.
+			if (parser.IsValid())
+			{
+				ScopedTimer timer("Analyzing the AST took: {} ms, {} ns");
+
+				Sema sema(ast);
+				isAnalyzed = sema.Analyze();
+			}
+
+			ScopedTimer timer("Lowering the AST took: {} ms, {} ns");
+			flatAst = FlatAst::Lower(ast.Statements, m_Args.Flags & CompilerFlags::ShareExpressions);
 		}
 
-		SYSTEM_INFO("Saved output to: {}", m_Args.OutputFile);
+		if (m_Args.Flags & CompilerFlags::VerboseParser)
+		{
+			SYSTEM_DEBUG("Statements: ");
 
-		if (ret != 0)
+			flatAst.Dump();
+		}
+
+		if (!parser.IsValid())
 		{
-			SYSTEM_ERROR("Failed to compile the generated IR. Exiting.");
+			SYSTEM_ERROR("Parsing failed. Syntax errors occurred. Exiting.");
 
-			return;
+			return false;
 		}
+
+		if (!isAnalyzed)
+		{
+			SYSTEM_ERROR("Analysis failed. Semantic errors occurred. Exiting.");
+
+			return false;
+		}
+
+		return true;
 	}
 } // namespace WandeltCore
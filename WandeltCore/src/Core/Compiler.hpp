@@ -12,11 +12,13 @@ namespace WandeltCore
 {
 	enum CompilerFlags : u32
 	{
-		None           = 0,                                             // No flags
-		VerboseLexer   = 1 << 0,                                        // Display lexer output
-		VerboseParser  = 1 << 1,                                        // Display parser output
-		VerboseCodegen = 1 << 2,                                        // Display codegen output
-		Verbose        = VerboseLexer | VerboseParser | VerboseCodegen, // Display all output
+		None              = 0,                                             // No flags
+		VerboseLexer      = 1 << 0,                                        // Display lexer output
+		VerboseParser     = 1 << 1,                                        // Display parser output
+		VerboseCodegen    = 1 << 2,                                        // Display codegen output
+		Verbose           = VerboseLexer | VerboseParser | VerboseCodegen, // Display all output
+		ShareExpressions  = 1 << 3,                                        // Lower equal pure expressions to one node
+		CheckedArithmetic = 1 << 4,                                        // Trap on overflows and divisions by 0
 	};
 
 	struct CompilerArguments
@@ -24,8 +26,14 @@ namespace WandeltCore
 		std::filesystem::path InputFile;
 		std::filesystem::path OutputFile;
 		CompilerFlags Flags = CompilerFlags::None;
+
+		std::filesystem::path CacheDirectory; // Where parsed ASTs are cached, empty to always parse
+		u32 ErrorLimit = 20;                  // Syntax errors after which compiling stops, 0 for no limit
 	};
 
+	class Lexer;
+	class FlatAst;
+
 	class Compiler
 	{
 	public:
@@ -34,6 +42,10 @@ namespace WandeltCore
 
 		void Compile();
 
+	private:
+		// Lex, parse and lower the input file. Returns false if there were errors, they have been reported then.
+		bool LexAndParse(Lexer& lexer, FlatAst& flatAst);
+
 	private:
 		CompilerArguments m_Args;
 	};
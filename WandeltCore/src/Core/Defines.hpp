@@ -67,3 +67,17 @@ static_assert(sizeof(b32) == 4, "b32 is not 4 bytes");
 #else
 	#define FORCE_INLINE inline __attribute__((always_inline))
 #endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SW_SIMD_SSE2 // SSE2 is guaranteed at compile time
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define SW_SIMD_AVX2 // AVX2 code paths are compiled in, whether they are used is decided at runtime
+#endif
+
+#ifdef SW_COMPILER_MSVC
+	#define SW_TARGET_AVX2
+#else
+	#define SW_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
@@ -4,12 +4,45 @@
 
 namespace WandeltCore::Error
 {
+	void ReportError(LexerErrorCode code, const SourceLocation& location, std::string_view text)
+	{
+		const ResolvedLocation resolved = SourceManager::Resolve(location);
+
+		SYSTEM_ERROR("");
+		SYSTEM_ERROR("[Lexer] - Syntax error!");
+
+		if (code == LexerErrorCode::UNEXPECTED_CHARACTER)
+		{
+			SYSTEM_ERROR("Unexpected character '{}'. At line: {} column: {}.", text, resolved.Line, resolved.Column);
+		}
+		else if (code == LexerErrorCode::UNTERMINATED_BLOCK_COMMENT)
+		{
+			SYSTEM_ERROR("Unterminated block comment. At line: {} column: {}.", resolved.Line, resolved.Column);
+		}
+		else if (code == LexerErrorCode::INVALID_NUMBER_LITERAL)
+		{
+			SYSTEM_ERROR("Invalid number literal '{}'. At line: {} column: {}.", text, resolved.Line,
+			             resolved.Column);
+		}
+		else if (code == LexerErrorCode::NUMBER_LITERAL_TOO_LARGE)
+		{
+			SYSTEM_ERROR("Number literal '{}' does not fit in 64 bits. At line: {} column: {}.", text, resolved.Line,
+			             resolved.Column);
+		}
+
+		SYSTEM_TRACE("{}", resolved.CodeLine);
+		SYSTEM_INFO(getIndent(resolved.Column - 1, 1) + "^");
+
+		SYSTEM_ERROR("__________________________________________________________");
+		SYSTEM_ERROR("");
+	}
+
 	std::nullptr_t ReportError(ParserErrorCode code, const Token& lastToken)
 	{
-		const SourceLocation& location = lastToken.Location;
+		const ResolvedLocation location = SourceManager::Resolve(lastToken.GetLocation());
 
 		const std::string_view& stringifiedToken =
-		    lastToken.HasLexeme() ? lastToken.Lexeme.value() : TokenTypeToStringRepresentation(lastToken.Type);
+		    lastToken.HasLexeme() ? lastToken.GetLexeme() : TokenTypeToStringRepresentation(lastToken.Type);
 
 		const u32 indicatorLocation = stringifiedToken.size() + location.Column;
 
@@ -60,6 +93,20 @@ namespace WandeltCore::Error
 			SYSTEM_TRACE("{}", location.CodeLine);
 			SYSTEM_INFO(getIndent(indicatorLocation - 1, 1) + "^");
 		}
+		else if (code == ParserErrorCode::MISSING_VARIABLE_IDENTIFIER)
+		{
+			SYSTEM_ERROR("Expected a variable after 'let' received '{}'. At line: {} column: {}.", stringifiedToken,
+			             location.Line, location.Column);
+			SYSTEM_TRACE("{}", location.CodeLine);
+			SYSTEM_INFO(getIndent(indicatorLocation - 2, 1) + "^");
+		}
+		else if (code == ParserErrorCode::MISSING_EQUALS)
+		{
+			SYSTEM_ERROR("Expected '=' after the '{}'. At line: {} column: {}.", stringifiedToken, location.Line,
+			             location.Column);
+			SYSTEM_TRACE("{}", location.CodeLine);
+			SYSTEM_INFO(getIndent(indicatorLocation - 1, 1) + "^");
+		}
 		else if (code == ParserErrorCode::UNEXPECTED_TOKEN)
 		{
 			SYSTEM_ERROR("Unexpected token '{}'. At line: {} column: {}.", stringifiedToken, location.Line,
@@ -73,4 +120,29 @@ namespace WandeltCore::Error
 
 		return nullptr;
 	}
+
+	void ReportError(SemanticErrorCode code, const SourceLocation& location, std::string_view name)
+	{
+		const ResolvedLocation resolved = SourceManager::Resolve(location);
+
+		SYSTEM_ERROR("");
+		SYSTEM_ERROR("[Sema] - Semantic error!");
+
+		if (code == SemanticErrorCode::UNDECLARED_VARIABLE)
+		{
+			SYSTEM_ERROR("Variable '{}' is not declared. At line: {} column: {}.", name, resolved.Line,
+			             resolved.Column);
+		}
+		else if (code == SemanticErrorCode::REDECLARED_VARIABLE)
+		{
+			SYSTEM_ERROR("Variable '{}' is already declared in this scope. At line: {} column: {}.", name,
+			             resolved.Line, resolved.Column);
+		}
+
+		SYSTEM_TRACE("{}", resolved.CodeLine);
+		SYSTEM_INFO(getIndent(resolved.Column - 1, 1) + "^");
+
+		SYSTEM_ERROR("__________________________________________________________");
+		SYSTEM_ERROR("");
+	}
 } // namespace WandeltCore::Error
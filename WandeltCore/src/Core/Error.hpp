@@ -10,6 +10,7 @@
 
 namespace WandeltCore
 {
+	struct SourceLocation;
 	struct Token;
 
 	enum class ErrorType : u8
@@ -23,22 +24,30 @@ namespace WandeltCore
 
 	enum class LexerErrorCode : u8
 	{
+		UNEXPECTED_CHARACTER,       // Character that does not start any token
+		UNTERMINATED_BLOCK_COMMENT, // Block comment without the closing '*/'
+		INVALID_NUMBER_LITERAL,     // Number literal with a digit not valid in its base or a misplaced '_'
+		NUMBER_LITERAL_TOO_LARGE,   // Number literal that does not fit in 64 bits
 	};
 
 	enum class ParserErrorCode : u8
 	{
-		MISSING_SEMICOLON,         // Missing semicolon ';' at the end of a statement
-		MISSING_EXPRESSION,        // Missing expression in a statement that requires one
-		MISSING_LEFT_PARENTHESIS,  // Missing left parentheses '('
-		MISSING_RIGHT_PARENTHESIS, // Missing right parentheses ')'
-		MISSING_LEFT_BRACE,        // Missing left brace '{'
-		MISSING_RIGHT_BRACE,       // Missing right brace '}'
-		MISSING_SCOPE_CLOSING,     // Missing closing scope
-		UNEXPECTED_TOKEN,          // Unexpected token
+		MISSING_SEMICOLON,           // Missing semicolon ';' at the end of a statement
+		MISSING_EXPRESSION,          // Missing expression in a statement that requires one
+		MISSING_LEFT_PARENTHESIS,    // Missing left parentheses '('
+		MISSING_RIGHT_PARENTHESIS,   // Missing right parentheses ')'
+		MISSING_LEFT_BRACE,          // Missing left brace '{'
+		MISSING_RIGHT_BRACE,         // Missing right brace '}'
+		MISSING_SCOPE_CLOSING,       // Missing closing scope
+		MISSING_VARIABLE_IDENTIFIER, // Missing variable '$name' after 'let'
+		MISSING_EQUALS,              // Missing '=' between the variable and the initializer of a 'let'
+		UNEXPECTED_TOKEN,            // Unexpected token
 	};
 
 	enum class SemanticErrorCode : u8
 	{
+		UNDECLARED_VARIABLE, // Variable read without a declaration in the scope or one around it
+		REDECLARED_VARIABLE, // Variable declared twice in the same scope
 	};
 
 	enum class CodegenErrorCode : u8
@@ -51,6 +60,12 @@ namespace WandeltCore
 
 	namespace Error
 	{
+		// Report an error at the given location. The text is the offending part of the source.
+		void ReportError(LexerErrorCode code, const SourceLocation& location, std::string_view text);
+
 		std::nullptr_t ReportError(ParserErrorCode code, const Token& lastToken);
-	}
+
+		// Report an error about the named symbol at the given location.
+		void ReportError(SemanticErrorCode code, const SourceLocation& location, std::string_view name);
+	} // namespace Error
 } // namespace WandeltCore
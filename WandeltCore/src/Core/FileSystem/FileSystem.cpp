@@ -2,8 +2,76 @@
 
 #include <fstream>
 
+#ifdef SW_PLATFORM_WINDOWS
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 namespace WandeltCore
 {
+	MappedFile::MappedFile(std::string buffer) : m_Buffer(std::move(buffer))
+	{
+		m_Data = m_Buffer.data();
+		m_Size = m_Buffer.size();
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Unmap();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		Unmap();
+
+		m_IsMapped = other.m_IsMapped;
+		m_Size     = other.m_Size;
+		m_Buffer   = std::move(other.m_Buffer);
+
+		// A small buffer may live inside the string object itself, so it has to be re-pointed after the move.
+		m_Data = m_IsMapped ? other.m_Data : m_Buffer.data();
+
+		other.m_Data     = nullptr;
+		other.m_Size     = 0;
+		other.m_IsMapped = false;
+
+		return *this;
+	}
+
+	void MappedFile::Unmap()
+	{
+		if (!m_IsMapped)
+			return;
+
+#ifdef SW_PLATFORM_WINDOWS
+		UnmapViewOfFile(m_Data);
+#else
+		munmap(const_cast<char*>(m_Data), m_Size);
+#endif
+
+		m_Data     = nullptr;
+		m_Size     = 0;
+		m_IsMapped = false;
+	}
+
 	bool FileSystem::Exists(const char* path)
 	{
 		return std::filesystem::exists(path);
@@ -46,4 +114,83 @@ namespace WandeltCore
 	{
 		return ReadFile(filepath.string().c_str());
 	}
+
+	bool FileSystem::WriteFile(const std::filesystem::path& filepath, std::string_view contents)
+	{
+		std::ofstream stream(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!stream.is_open())
+			return false;
+
+		stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+		stream.close();
+
+		return !stream.fail();
+	}
+
+	MappedFile FileSystem::MapFile(const std::filesystem::path& filepath)
+	{
+		MappedFile file;
+
+#ifdef SW_PLATFORM_WINDOWS
+		HANDLE handle = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (handle != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER size;
+
+			// Empty files can not be mapped, they take the buffered path below.
+			if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+			{
+				HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+				if (mapping)
+				{
+					if (const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))
+					{
+						file.m_Data     = static_cast<const char*>(view);
+						file.m_Size     = static_cast<size_t>(size.QuadPart);
+						file.m_IsMapped = true;
+					}
+
+					// The view keeps the mapping alive on its own.
+					CloseHandle(mapping);
+				}
+			}
+
+			CloseHandle(handle);
+		}
+#else
+		const int fd = open(filepath.c_str(), O_RDONLY);
+
+		if (fd != -1)
+		{
+			struct stat info;
+
+			// Empty files can not be mapped, they take the buffered path below.
+			if (fstat(fd, &info) == 0 && info.st_size > 0)
+			{
+				void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+				if (view != MAP_FAILED)
+				{
+					madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+					file.m_Data     = static_cast<const char*>(view);
+					file.m_Size     = static_cast<size_t>(info.st_size);
+					file.m_IsMapped = true;
+				}
+			}
+
+			// The mapping stays valid after the descriptor is closed.
+			close(fd);
+		}
+#endif
+
+		if (!file.IsMapped())
+			file = MappedFile(ReadFile(filepath));
+
+		return file;
+	}
 } // namespace WandeltCore
@@ -10,6 +10,39 @@
 
 namespace WandeltCore
 {
+	// Read-only view of the contents of a file. Backed by a memory mapping when the platform allows it,
+	// otherwise by a buffer the contents were read into. The view stays valid for the lifetime of the object.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(std::string buffer);
+		~MappedFile();
+
+		MappedFile(const MappedFile&)            = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		std::string_view GetView() const { return {m_Data, m_Size}; }
+
+		bool IsMapped() const { return m_IsMapped; }
+
+	private:
+		void Unmap();
+
+	private:
+		const char* m_Data = nullptr; // Start of the contents, either the mapping or the buffer
+		size_t m_Size      = 0;       // Size of the contents in bytes
+
+		bool m_IsMapped = false; // Whether m_Data points into a memory mapping
+
+		std::string m_Buffer; // Fallback storage when the file could not be mapped
+
+		friend class FileSystem;
+	};
+
 	class FileSystem
 	{
 	public:
@@ -23,5 +56,13 @@ namespace WandeltCore
 		static std::string ReadFile(const char* filepath);
 		static std::string ReadFile(const std::string& filepath);
 		static std::string ReadFile(const std::filesystem::path& filepath);
+
+		// Write the contents to a file at the given path, replacing the file if it exists.
+		// Returns whether the whole contents were written.
+		static bool WriteFile(const std::filesystem::path& filepath, std::string_view contents);
+
+		// Map the contents of a file at the given path into memory, read-only and without copying.
+		// Falls back to reading the file into a buffer if it can not be mapped. The file must exist.
+		static MappedFile MapFile(const std::filesystem::path& filepath);
 	};
 } // namespace WandeltCore
@@ -1,263 +1,499 @@
 #include "Lexer.hpp"
 
-#include "Core/FileSystem/FileSystem.hpp"
+#include <algorithm>
 
-#define TOKEN_CASE(x)                \
-	AddToken(tokenStartLocation, x); \
-	break;
+#include "Core/FileSystem/FileSystem.hpp"
+#include "Core/ThreadPool/ThreadPool.hpp"
+#include "ScanTable.hpp"
+#include "SimdScanner.hpp"
 
 namespace WandeltCore
 {
-	Lexer::Lexer(const std::filesystem::path& filepath) : m_Filename(filepath.filename().string())
+	namespace
+	{
+		// Value of a digit in bases up to 16, 16 for characters that are no digit.
+		u32 DigitValue(char c)
+		{
+			if (c >= '0' && c <= '9')
+				return c - '0';
+
+			const char lower = c | 0x20;
+
+			if (lower >= 'a' && lower <= 'f')
+				return lower - 'a' + 10;
+
+			return 16;
+		}
+
+		// Decode a number literal. Decimal, or hexadecimal and binary with a 0x and 0b prefix. Digits may be
+		// separated by single '_'. Returns the error to report when the literal is malformed or too large.
+		std::optional<LexerErrorCode> DecodeNumber(std::string_view literal, u64& value)
+		{
+			u32 base = 10;
+			size_t i = 0;
+
+			if (literal.size() > 2 && literal[0] == '0')
+			{
+				const char prefix = literal[1] | 0x20;
+
+				if (prefix == 'x')
+					base = 16;
+				else if (prefix == 'b')
+					base = 2;
+
+				if (base != 10)
+					i = 2;
+			}
+
+			bool hasDigits     = false; // Whether a digit was seen
+			bool endsWithSplit = false; // Whether the last character was a '_'
+			bool isOverflowing = false; // Whether the value exceeded 64 bits
+
+			value = 0;
+
+			for (; i < literal.size(); ++i)
+			{
+				if (literal[i] == '_')
+				{
+					if (!hasDigits || endsWithSplit)
+						return LexerErrorCode::INVALID_NUMBER_LITERAL;
+
+					endsWithSplit = true;
+					continue;
+				}
+
+				const u32 digit = DigitValue(literal[i]);
+
+				if (digit >= base)
+					return LexerErrorCode::INVALID_NUMBER_LITERAL;
+
+				if (value > (std::numeric_limits<u64>::max() - digit) / base)
+					isOverflowing = true;
+
+				value         = value * base + digit;
+				hasDigits     = true;
+				endsWithSplit = false;
+			}
+
+			if (!hasDigits || endsWithSplit)
+				return LexerErrorCode::INVALID_NUMBER_LITERAL;
+
+			if (isOverflowing)
+				return LexerErrorCode::NUMBER_LITERAL_TOO_LARGE;
+
+			return std::nullopt;
+		}
+	} // namespace
+
+	Lexer::Lexer(const std::filesystem::path& filepath)
 	{
 		ASSERT(FileSystem::Exists(filepath), "Input file `{}` does not exist",
 		       std::filesystem::absolute(filepath).string());
 
 		SYSTEM_INFO("Input file: {}", filepath.filename());
 
-		m_Source = FileSystem::ReadFile(filepath);
+		m_FileID = SourceManager::AddFile(filepath.filename().string(), FileSystem::MapFile(filepath));
+		m_Source = SourceManager::GetSource(m_FileID);
+	}
+
+	Lexer::Lexer(const std::string& filename, const std::string& source)
+	    : m_FileID(SourceManager::AddFile(filename, MappedFile(source)))
+	{
+		m_Source = SourceManager::GetSource(m_FileID);
+	}
+
+	Lexer::Lexer(u16 fileID, u32 begin)
+	    : m_Source(SourceManager::GetSource(fileID)), m_FileID(fileID), m_Start(begin), m_Current(begin)
+	{
 	}
 
-	Lexer::Lexer(const std::string& filename, const std::string& source) : m_Source(source), m_Filename(filename)
+	Lexer::Lexer(u16 fileID, u32 begin, u32 end, StringInterner& interner)
+	    : m_Source(SourceManager::GetSource(fileID).substr(0, end)), m_FileID(fileID), m_Start(begin),
+	      m_Current(begin), m_Interner(&interner), m_ReportErrors(false)
 	{
+		// Offsets stay relative to the start of the file, only the end of the view moves.
 	}
 
 	void Lexer::Lex()
 	{
-		while (!IsAtEnd() && m_IsValid)
+		if (IsLexedInParallel())
 		{
-			m_Start = m_Current;
+			LexParallel();
 
-			ScanToken();
+#ifdef SW_DEBUG_BUILD
+			CheckParallelTokens();
+#endif
+		}
+		else
+		{
+			LexSerial();
 		}
+	}
 
-		AddToken({m_Filename, m_Line, m_Column}, TokenType::END_OF_FILE);
+	bool Lexer::IsLexedInParallel() const
+	{
+		return m_Source.size() >= ParallelThreshold && ThreadPool::Get().GetThreadCount() > 1;
 	}
 
-	bool Lexer::IsMatchingNext(char expected)
+	std::vector<u32> Lexer::FindChunkBoundaries(std::string_view source, u32 chunkCount)
 	{
-		if (IsAtEnd())
-			return false;
+		const u32 size = static_cast<u32>(source.size());
 
-		if (m_Source[m_Current] != expected)
-			return false;
+		std::vector<u32> boundaries = {0};
 
-		Advance();
+		u32 position = 0; // Everything before is known to be outside or at the end of a comment
 
-		return true;
-	}
+		for (u32 i = 1; i < chunkCount; i++)
+		{
+			u32 target = std::max<u32>(static_cast<u32>(u64(size) * i / chunkCount), boundaries.back());
 
-	char Lexer::Advance()
-	{
-		++m_Column;
+			while (true)
+			{
+				const size_t newline = source.find('\n', target);
 
-		if (m_Source[m_Current] == '\n')
-		{
-			++m_Line;
-			m_Column = 0;
+				if (newline == std::string_view::npos)
+				{
+					boundaries.push_back(size);
+
+					return boundaries;
+				}
+
+				// Skip over the comments that start before the newline. Only a block comment can contain it.
+				while (true)
+				{
+					const size_t slash = source.find('/', position);
+
+					if (slash == std::string_view::npos || slash >= newline)
+						break;
+
+					const char next = slash + 1 < size ? source[slash + 1] : '\0';
+
+					if (next == '*')
+						position = SimdScanner::FindBlockCommentEnd(source, static_cast<u32>(slash) + 2) + 2;
+					else if (next == '/')
+						position = SimdScanner::FindLineEnd(source, static_cast<u32>(slash) + 2);
+					else
+						position = static_cast<u32>(slash) + 1;
+				}
+
+				if (position <= newline)
+				{
+					boundaries.push_back(static_cast<u32>(newline) + 1);
+					position = std::max<u32>(position, boundaries.back());
+					break;
+				}
+
+				if (position >= size)
+				{
+					// The rest of the source is one (possibly unterminated) block comment.
+					boundaries.push_back(size);
+
+					return boundaries;
+				}
+
+				// The newline is inside of a block comment, try the first one after it.
+				target = position;
+			}
 		}
 
-		return m_Source[m_Current++];
+		boundaries.push_back(size);
+
+		return boundaries;
 	}
 
-	char Lexer::LookAhead(u32 offset) const
+	void Lexer::LexSerial()
 	{
-		return m_Source[m_Current + offset];
+		while (true)
+		{
+			const Token token = NextToken();
+
+			m_Tokens.push_back(token);
+
+			if (token.Type == TokenType::END_OF_FILE)
+				break;
+		}
 	}
 
-	void Lexer::ScanToken()
+	void Lexer::LexParallel()
 	{
-		char c = Advance();
+		// Chunks of at least a megabyte, so the work per chunk outweighs the scheduling.
+		constexpr u32 minChunkSize = 1024 * 1024;
 
-		// Find the start of the line
-		int lineStart = m_Source.rfind('\n', m_Current - 1);
-		if (lineStart == std::string::npos)
-			lineStart = 0; // If no previous newline, start from the beginning
-		else
-			lineStart += 1; // Move to the character after the newline
+		ThreadPool& pool = ThreadPool::Get();
+
+		const u32 chunkCount = std::max(
+		    std::min(pool.GetThreadCount(), static_cast<u32>(m_Source.size() / minChunkSize)), 1u);
+
+		const std::vector<u32> boundaries = FindChunkBoundaries(m_Source, chunkCount);
 
-		// Find the end of the line
-		int lineEnd = m_Source.find('\n', m_Current);
-		if (lineEnd == std::string::npos)
+		std::vector<std::vector<Token>> chunkTokens(boundaries.size() - 1);
+		std::vector<StringInterner> chunkInterners(boundaries.size() - 1);
+		std::vector<u8> chunkValid(boundaries.size() - 1, false);
+
+		pool.ParallelFor(static_cast<u32>(chunkTokens.size()), [&](u32 chunk) {
+			Lexer lexer(m_FileID, boundaries[chunk], boundaries[chunk + 1], chunkInterners[chunk]);
+
+			lexer.LexSerial();
+			lexer.m_Tokens.pop_back(); // Only the last chunk ends the file
+
+			chunkTokens[chunk] = std::move(lexer.m_Tokens);
+			chunkValid[chunk]  = lexer.m_IsValid;
+		});
+
+		if (std::find(chunkValid.begin(), chunkValid.end(), false) != chunkValid.end())
 		{
-			lineEnd = m_Source.length(); // If no next newline, go to the end of the source
-		}
+			// Lex serially again, so errors are reported exactly as without chunking.
+			LexSerial();
 
-		// Extract the entire line
-		std::string_view fullLine(m_Source.data() + lineStart, lineEnd - lineStart);
+			return;
+		}
 
-		const SourceLocation tokenStartLocation = {fullLine, m_Line, m_Column};
+		// Merging the chunk interners in order interns names in the order the serial lexer first sees them,
+		// so the symbol ids come out the same.
+		std::vector<SymbolID> remap;
 
-		switch (c)
+		for (u32 chunk = 0; chunk < chunkTokens.size(); chunk++)
 		{
-		case ' ':
-		case '\r':
-		case '\t':
-		case '\n':
-			// Ignore whitespace.
-			break;
-		case ',':
-			TOKEN_CASE(TokenType::COMMA);
-		case '.':
-			TOKEN_CASE(TokenType::DOT);
-		case ';':
-			TOKEN_CASE(TokenType::SEMICOLON);
-		case '(':
-			TOKEN_CASE(TokenType::LEFT_PARENTHESES);
-		case ')':
-			TOKEN_CASE(TokenType::RIGHT_PARENTHESES);
-		case '{':
-			TOKEN_CASE(TokenType::LEFT_BRACE);
-		case '}':
-			TOKEN_CASE(TokenType::RIGHT_BRACE);
-		case '+':
-			TOKEN_CASE(TokenType::PLUS);
-		case '-':
-			TOKEN_CASE(TokenType::MINUS);
-		case '=': {
-			if (IsMatchingNext('='))
-			{
-				TOKEN_CASE(TokenType::EQUAL_EQUAL);
-			}
-			else
+			const StringInterner& interner = chunkInterners[chunk];
+
+			remap.resize(interner.GetSize());
+
+			for (SymbolID id = 0; id < interner.GetSize(); id++) remap[id] = m_Interner->Intern(interner.GetString(id));
+
+			for (Token& token : chunkTokens[chunk])
 			{
-				TOKEN_CASE(TokenType::EQUALS);
+				if (token.IsIdentifier())
+					token.Symbol = remap[token.Symbol];
 			}
 		}
-		case '!': {
-			if (IsMatchingNext('='))
-			{
-				TOKEN_CASE(TokenType::BANG_EQUAL);
-			}
-			else
-			{
-				SYSTEM_ERROR("Unexpected character: {} at line: {} column: {}. Skipping.", c, tokenStartLocation.Line,
-				             tokenStartLocation.Column);
 
-				m_IsValid = false;
-				break;
-			}
-		}
-		case '<': {
-			if (IsMatchingNext('='))
-			{
-				TOKEN_CASE(TokenType::LESS_EQUAL);
-			}
-			else
-			{
-				TOKEN_CASE(TokenType::LESS);
-			}
+		size_t tokenCount = 1;
+
+		for (const std::vector<Token>& tokens : chunkTokens)
+			tokenCount += tokens.size();
+
+		m_Tokens.reserve(tokenCount);
+
+		for (const std::vector<Token>& tokens : chunkTokens)
+			m_Tokens.insert(m_Tokens.end(), tokens.begin(), tokens.end());
+
+		// Tokens carry file offsets, so they need no correction. The end of file is at the end of the source.
+		m_Start = m_Current = static_cast<u32>(m_Source.size());
+
+		EmitToken(TokenType::END_OF_FILE);
+		m_Tokens.push_back(m_Token);
+	}
+
+	void Lexer::CheckParallelTokens() const
+	{
+		StringInterner interner;
+
+		Lexer serial(m_FileID, 0, static_cast<u32>(m_Source.size()), interner);
+		serial.LexSerial();
+
+		ASSERT(serial.m_Tokens.size() == m_Tokens.size(), "Parallel lexing produced {} tokens, serial lexing {}",
+		       m_Tokens.size(), serial.m_Tokens.size());
+
+		for (size_t i = 0; i < m_Tokens.size(); i++)
+		{
+			const Token& token    = m_Tokens[i];
+			const Token& expected = serial.m_Tokens[i];
+
+			// Names are compared by their text, the ids of the two interners differ.
+			const bool isSame =
+			    token.Type == expected.Type && token.Offset == expected.Offset && token.FileID == expected.FileID &&
+			    (token.Type != TokenType::NUMBER || token.Value == expected.Value) &&
+			    (!token.IsIdentifier() || m_Interner->GetString(token.Symbol) == interner.GetString(expected.Symbol));
+
+			ASSERT(isSame, "Parallel lexing differs from serial lexing at token {}, offset {}", i, expected.Offset);
 		}
-		case '>': {
-			if (IsMatchingNext('='))
-			{
-				TOKEN_CASE(TokenType::GREATER_EQUAL);
-			}
-			else
-			{
-				TOKEN_CASE(TokenType::GREATER);
-			}
+	}
+
+	Token Lexer::NextToken()
+	{
+		// Errors do not stop lexing, the offending characters are skipped so one pass finds all of them.
+		while (!IsAtEnd() && !HasReachedErrorLimit())
+		{
+			m_Start = m_Current;
+
+			if (ScanToken())
+				return m_Token;
 		}
-		case '*': {
-			if (IsMatchingNext('*'))
-			{
-				TOKEN_CASE(TokenType::DOUBLE_STAR);
-			}
-			else
+
+		m_Start = m_Current;
+
+		EmitToken(TokenType::END_OF_FILE);
+
+		return m_Token;
+	}
+
+	char Lexer::LookAhead(u32 offset) const
+	{
+		// Mapped sources are not null terminated, never read past the end of the view.
+		if (m_Current + offset >= m_Source.size())
+			return '\0';
+
+		return m_Source[m_Current + offset];
+	}
+
+	bool Lexer::ScanToken()
+	{
+		m_HasToken = false;
+
+		u8 state = ScanTable::StartState;
+
+		// Walk the transition table until the lexeme is complete. Past the end LookAhead returns '\0',
+		// which ends any operator that could still grow.
+		while (true)
+		{
+			const u8 charClass                     = ScanTable::CharClasses[static_cast<u8>(LookAhead())];
+			const ScanTable::Transition transition = ScanTable::Transitions[state][charClass];
+
+			switch (transition.Action)
 			{
-				TOKEN_CASE(TokenType::STAR);
-			}
-		}
-			// TOKEN_CASE(TokenType::STAR);
-		case '/': {
-			if (IsMatchingNext('/'))
+			case ScanAction::Advance:
+				m_Current++;
+				state = transition.Next;
+				break;
+			case ScanAction::Emit:
+				m_Current++;
+				EmitToken(transition.Type);
+				return true;
+			case ScanAction::EmitBefore:
+				EmitToken(transition.Type);
+				return true;
+			case ScanAction::SkipWhitespace:
+				// Ignore whitespace, the whole run at once.
+				m_Current = SimdScanner::SkipWhitespace(m_Source, m_Current);
+				return false;
+			case ScanAction::ScanNumber:
+				ScanNumber();
+				return m_HasToken;
+			case ScanAction::ScanIdentifier:
+				ScanIdentifier();
+				return true;
+			case ScanAction::LineComment:
 				// A comment goes until the end of the line.
-				while (LookAhead() != '\n' && !IsAtEnd()) Advance();
-			else if (IsMatchingNext('*'))
-			{
+				m_Current = SimdScanner::FindLineEnd(m_Source, m_Current + 1);
+				return false;
+			case ScanAction::BlockComment:
 				// A block comment goes until the end of the block.
-				while (!(LookAhead() == '*' && LookAhead(1) == '/') && !IsAtEnd())
-				{
-					Advance();
-				}
+				m_Current = SimdScanner::FindBlockCommentEnd(m_Source, m_Current + 1);
 
 				if (IsAtEnd())
 				{
-					SYSTEM_ERROR("Unterminated block comment at line: {} column: {}", m_Line, m_Current - m_Start);
-					m_IsValid = false;
-					break;
+					ReportError(LexerErrorCode::UNTERMINATED_BLOCK_COMMENT, m_Source.substr(m_Start, 2));
+					return false;
 				}
 
-				// Consume the '*/'
-				if (!IsAtEnd())
-				{
-					Advance();
-					Advance();
-				}
-			}
-			else
-				TOKEN_CASE(TokenType::SLASH);
-		}
-		case '%':
-			TOKEN_CASE(TokenType::PERCENT);
-		default:
-			if (IsDigit(c))
+				m_Current += 2; // Consume the '*/'
+				return false;
+			case ScanAction::Error:
 			{
-				while (IsDigit(LookAhead())) Advance();
+				// A run of characters that start no token is one error, like the bytes of a multibyte character.
+				const auto startsNoToken = [this]() {
+					const u8 charClass = ScanTable::CharClasses[static_cast<u8>(LookAhead())];
 
-				std::string lexeme = m_Source.substr(m_Start, m_Current - m_Start);
+					return !IsAtEnd() &&
+					       ScanTable::Transitions[ScanTable::StartState][charClass].Action == ScanAction::Error;
+				};
 
-				AddToken(tokenStartLocation, TokenType::NUMBER, lexeme);
+				m_Current = m_Start + 1;
 
-				break;
+				while (startsNoToken()) m_Current++;
+
+				ReportError(LexerErrorCode::UNEXPECTED_CHARACTER, m_Source.substr(m_Start, m_Current - m_Start));
+				return false;
 			}
-			else if (IsAlpha(c))
-			{
-				while (IsAlpha(LookAhead()) || IsDigit(LookAhead())) Advance();
+			}
+		}
+	}
 
-				std::string lexeme = m_Source.substr(m_Start, m_Current - m_Start);
+	void Lexer::ScanIdentifier()
+	{
+		m_Current = SimdScanner::SkipIdentifier(m_Source, m_Current);
 
-				auto it = Keywords.find(lexeme);
-				if (it != Keywords.end())
-				{
-					AddToken(tokenStartLocation, it->second);
-				}
-				else
-				{
-					// if (c != '$')
-					// {
-					// 	SYSTEM_ERROR(
-					// 	    "Variable names must start with a $ character. Missing $ before: {} at line: {} column: {}",
-					// 	    lexeme, tokenStartLocation.Line, tokenStartLocation.Column);
-					// 	break;
-					// }
-
-					if (c == '$')
-						AddToken(tokenStartLocation, TokenType::VARIABLE_IDENTIFIER, lexeme);
-					else
-						AddToken(tokenStartLocation, TokenType::FUNCTION_IDENTIFIER, lexeme);
-				}
+		const std::string_view lexeme = m_Source.substr(m_Start, m_Current - m_Start);
 
-				break;
-			}
+		if (const std::optional<TokenType> keyword = FindKeyword(lexeme))
+		{
+			EmitToken(keyword.value());
 
-			SYSTEM_ERROR("Unexpected character: {} at line: {} column: {}. Skipping.", c, tokenStartLocation.Line,
-			             tokenStartLocation.Column);
+			return;
+		}
 
-			m_IsValid = false;
+		if (lexeme.front() == '$')
+			EmitToken(TokenType::VARIABLE_IDENTIFIER);
+		else
+			EmitToken(TokenType::FUNCTION_IDENTIFIER);
 
-			break;
+		m_Token.Symbol = m_Interner->Intern(lexeme);
+	}
+
+	void Lexer::ScanNumber()
+	{
+		const u32 digitsEnd = SimdScanner::SkipDigits(m_Source, m_Current);
+
+		m_Current = SkipNumberLiteral(m_Source, digitsEnd);
+
+		const std::string_view literal = m_Source.substr(m_Start, m_Current - m_Start);
+
+		u64 value = 0;
+
+		if (m_Current == digitsEnd && literal.size() <= std::numeric_limits<u64>::digits10)
+		{
+			// Plain decimal literals short enough to never overflow take a loop without any checks.
+			for (const char digit : literal) value = value * 10 + static_cast<u32>(digit - '0');
+		}
+		else if (const std::optional<LexerErrorCode> error = DecodeNumber(literal, value))
+		{
+			ReportError(error.value(), literal);
+
+			return;
+		}
+
+		EmitToken(TokenType::NUMBER);
+
+		m_Token.Value = value;
+	}
+
+	u32 Lexer::SkipNumberLiteral(std::string_view source, u32 position)
+	{
+		const u32 size = static_cast<u32>(source.size());
+
+		while (position < size)
+		{
+			const char c     = source[position];
+			const char lower = c | 0x20;
+
+			if (!((c >= '0' && c <= '9') || (lower >= 'a' && lower <= 'z') || c == '_'))
+				break;
+
+			++position;
 		}
+
+		return position;
 	}
 
-	void Lexer::AddToken(const SourceLocation& location, TokenType type)
+	void Lexer::EmitToken(TokenType type)
 	{
-		m_Tokens.push_back(Token{type, std::nullopt, location});
+		m_Token        = {};
+		m_Token.Offset = m_Start;
+		m_Token.FileID = m_FileID;
+		m_Token.Type   = type;
+		m_HasToken     = true;
 	}
 
-	void Lexer::AddToken(const SourceLocation& location, TokenType type, const std::string& lexeme)
+	void Lexer::ReportError(LexerErrorCode code, std::string_view text)
 	{
-		m_Tokens.push_back(Token{type, lexeme, location});
+		if (m_ReportErrors)
+			Error::ReportError(code, {m_FileID, m_Start}, text);
+
+		m_IsValid = false;
+		m_ErrorCount++;
+
+		if (HasReachedErrorLimit() && m_ReportErrors)
+			SYSTEM_ERROR("Too many errors, stopping.");
 	}
 
 	//
@@ -28,51 +28,98 @@ namespace WandeltCore
 		// Mostly for testing purposes
 		Lexer(const std::string& filename, const std::string& source);
 
-		// Lex the source code
+		// Lexer for a file that has already been added, starting at the given offset. The offset has to be where a
+		// token or the whitespace before one starts, for relexing part of a file after an edit.
+		Lexer(u16 fileID, u32 begin);
+
+		// Lex the whole source code up front into GetTokens(). Large sources are split into chunks
+		// that are lexed in parallel, the resulting tokens are the same as when lexing serially.
 		void Lex();
 
+		// Lex and return only the next token, for consuming the source on demand. Characters that start no token
+		// are reported and skipped. Returns END_OF_FILE once the end or the error limit is reached, and keeps
+		// returning it.
+		Token NextToken();
+
 		const std::vector<Token>& GetTokens() const { return m_Tokens; }
 
 		bool IsValid() const { return m_IsValid; }
 
-	private:
-		// Check if we are at the end of the source file
-		bool IsAtEnd() const { return m_Current >= m_Source.size() - 1; }
+		// Stop lexing once this many errors were reported, 0 for no limit.
+		void SetErrorLimit(u32 limit) { m_ErrorLimit = limit; }
+
+		u32 GetErrorCount() const { return m_ErrorCount; }
+		bool HasReachedErrorLimit() const { return m_ErrorLimit != 0 && m_ErrorCount >= m_ErrorLimit; }
 
-		// Check if a character is a digit or not
-		bool IsDigit(char c) const { return c >= '0' && c <= '9'; }
+		u16 GetFileID() const { return m_FileID; }
 
-		// Check if a character is a letter or not (a-z, A-Z, $). Includes $ for identifiers.
-		bool IsAlpha(char c) const { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '$'; }
+		// Whether Lex splits the source into chunks lexed in parallel.
+		bool IsLexedInParallel() const;
 
-		// Check if a character is a whitespace character
-		bool IsWhitespace(char c) const { return c == ' ' || c == '\t' || c == '\r'; }
+		// Sources of at least this many bytes are lexed in parallel.
+		static constexpr u32 ParallelThreshold = 2 * 1024 * 1024;
+
+		// Split the source into at most chunkCount chunks of roughly equal size. Chunks end right after a
+		// newline outside of any comment, so no token or comment spans two chunks. Returns the start offset
+		// of every chunk, followed by the size of the source.
+		static std::vector<u32> FindChunkBoundaries(std::string_view source, u32 chunkCount);
+
+		// Skip the characters of a number literal, digits, letters and '_'. Whether they form a valid
+		// literal is checked when it is decoded.
+		static u32 SkipNumberLiteral(std::string_view source, u32 position);
+
+	private:
+		// Lexer for the [begin, end) chunk of an already added file, interning names into the given interner.
+		// Does not report errors, a failed chunk gets lexed again serially.
+		Lexer(u16 fileID, u32 begin, u32 end, StringInterner& interner);
 
-		// Check if next character matches the expected character. Consume the character if it matches.
-		bool IsMatchingNext(char expected);
+		void LexSerial();
+		void LexParallel();
 
-		// Advance and consume the current character.
-		char Advance();
+		// Lex the source serially again and assert the tokens are the same as the ones lexed in parallel. Run
+		// after every parallel lex in debug builds.
+		void CheckParallelTokens() const;
 
-		// Look ahead at the current character. Does not consume the character.
+		// Check if we are at the end of the source file
+		bool IsAtEnd() const { return m_Current >= m_Source.size(); }
+
+		// Look ahead at the current character. Does not consume the character. Returns '\0' past the end.
 		char LookAhead(u32 offset = 0) const;
 
-		void ScanToken();
+		// Scan the lexeme starting at the current character, driven by the ScanTable. Returns whether it
+		// produced a token, whitespace and comments do not.
+		bool ScanToken();
+
+		// Scan the identifier or keyword starting at the current lexeme.
+		void ScanIdentifier();
+
+		// Scan the number literal starting at the current lexeme and decode its value.
+		void ScanNumber();
 
-		void AddToken(const SourceLocation& location, TokenType type);
-		void AddToken(const SourceLocation& location, TokenType type, const std::string& lexeme);
+		// Emit a token starting at the current lexeme.
+		void EmitToken(TokenType type);
+
+		// Report an error at the start of the current lexeme, unless errors are not reported.
+		void ReportError(LexerErrorCode code, std::string_view text);
 
 	private:
-		std::string m_Source;   // The source code
-		std::string m_Filename; // The filename
+		std::string_view m_Source; // The source code, a view into the file owned by the SourceManager
+		u16 m_FileID = 0;          // The id of the source file in the SourceManager
 
 		u32 m_Start   = 0; // The start of the current lexeme
 		u32 m_Current = 0; // The current character index
-		u32 m_Line    = 1; // The current line
-		u32 m_Column  = 0; // The current column
 
-		std::vector<Token> m_Tokens; // The lexed tokens
+		std::vector<Token> m_Tokens; // The lexed tokens, filled by Lex
+
+		StringInterner* m_Interner = &StringInterner::Get(); // Where identifier names are interned
+
+		Token m_Token{};         // The token produced by the last ScanToken
+		bool m_HasToken = false; // Whether the last ScanToken produced a token
+
+		bool m_IsValid      = true; // Whether the lexer is in a valid state
+		bool m_ReportErrors = true; // Whether errors get logged, false for chunks lexed in parallel
 
-		bool m_IsValid = true; // Whether the lexer is in a valid state
+		u32 m_ErrorCount = 0; // Errors reported so far
+		u32 m_ErrorLimit = 0; // Errors after which lexing stops, 0 for no limit
 	};
 } // namespace WandeltCore
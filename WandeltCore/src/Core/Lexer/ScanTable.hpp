@@ -0,0 +1,210 @@
+/**
+ * @file ScanTable.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+#include "Token.hpp"
+
+namespace WandeltCore
+{
+	// What the Lexer does when it sees a character in a given state.
+	enum class ScanAction : u8
+	{
+		Advance,        // Consume the character and move to the next state
+		Emit,           // Consume the character and emit the token
+		EmitBefore,     // Emit the token without consuming the character, it belongs to the next token
+		SkipWhitespace, // Skip the whitespace run starting at the character
+		ScanNumber,     // Scan the number literal starting at the character
+		ScanIdentifier, // Scan the identifier or keyword starting at the character
+		LineComment,    // Consume the character and skip to the end of the line
+		BlockComment,   // Consume the character and skip past the closing '*/'
+		Error,          // The lexeme is no valid token
+	};
+
+	struct ScanRule
+	{
+		std::string_view Text;
+		ScanAction Action;
+		TokenType Type = TokenType::END_OF_FILE;
+	};
+
+	// Every operator, punctuation and comment opener of the language, one or two characters long.
+	// The character classes and the transition table are generated from this list at compile time.
+	constexpr auto ScanRuleList = std::to_array<ScanRule>({
+	    {",", ScanAction::Emit, TokenType::COMMA},
+	    {".", ScanAction::Emit, TokenType::DOT},
+	    {";", ScanAction::Emit, TokenType::SEMICOLON},
+	    {"(", ScanAction::Emit, TokenType::LEFT_PARENTHESES},
+	    {")", ScanAction::Emit, TokenType::RIGHT_PARENTHESES},
+	    {"{", ScanAction::Emit, TokenType::LEFT_BRACE},
+	    {"}", ScanAction::Emit, TokenType::RIGHT_BRACE},
+	    {"+", ScanAction::Emit, TokenType::PLUS},
+	    {"-", ScanAction::Emit, TokenType::MINUS},
+	    {"%", ScanAction::Emit, TokenType::PERCENT},
+	    {"=", ScanAction::Emit, TokenType::EQUALS},
+	    {"==", ScanAction::Emit, TokenType::EQUAL_EQUAL},
+	    {"!=", ScanAction::Emit, TokenType::BANG_EQUAL},
+	    {"<", ScanAction::Emit, TokenType::LESS},
+	    {"<=", ScanAction::Emit, TokenType::LESS_EQUAL},
+	    {">", ScanAction::Emit, TokenType::GREATER},
+	    {">=", ScanAction::Emit, TokenType::GREATER_EQUAL},
+	    {"*", ScanAction::Emit, TokenType::STAR},
+	    {"**", ScanAction::Emit, TokenType::DOUBLE_STAR},
+	    {"/", ScanAction::Emit, TokenType::SLASH},
+	    {"//", ScanAction::LineComment},
+	    {"/*", ScanAction::BlockComment},
+	});
+
+	namespace ScanTable
+	{
+		constexpr u8 WhitespaceClass = 0; // ' ', '\t', '\r', '\n'
+		constexpr u8 DigitClass      = 1; // 0-9
+		constexpr u8 LetterClass     = 2; // a-z, A-Z, $
+		constexpr u8 OtherClass      = 3; // Anything that starts no token
+		constexpr u8 FirstRuleClass  = 4; // Every character used by a rule gets a class of its own
+
+		constexpr u8 StartState = 0;
+
+		constexpr std::array<u8, 256> BuildCharClasses()
+		{
+			std::array<u8, 256> classes = {};
+			classes.fill(OtherClass);
+
+			for (const char c : std::string_view(" \t\r\n")) classes[static_cast<u8>(c)] = WhitespaceClass;
+
+			for (u32 c = '0'; c <= '9'; c++) classes[c] = DigitClass;
+
+			for (u32 c = 'a'; c <= 'z'; c++) classes[c] = LetterClass;
+
+			for (u32 c = 'A'; c <= 'Z'; c++) classes[c] = LetterClass;
+
+			classes['$'] = LetterClass;
+
+			u8 next = FirstRuleClass;
+
+			for (const ScanRule& rule : ScanRuleList)
+			{
+				for (const char c : rule.Text)
+				{
+					if (classes[static_cast<u8>(c)] == OtherClass)
+						classes[static_cast<u8>(c)] = next++;
+				}
+			}
+
+			return classes;
+		}
+
+		constexpr std::array<u8, 256> CharClasses = BuildCharClasses();
+
+		constexpr u32 CountClasses()
+		{
+			u32 count = FirstRuleClass;
+
+			for (const u8 charClass : CharClasses) count = std::max<u32>(count, charClass + 1u);
+
+			return count;
+		}
+
+		constexpr u32 ClassCount = CountClasses();
+
+		// One state besides the start state for every first character of a two character rule,
+		// it is what the scanner is in after consuming that character.
+		constexpr std::array<u8, 256> BuildStates()
+		{
+			std::array<u8, 256> states = {};
+			u8 next                    = StartState + 1;
+
+			for (const ScanRule& rule : ScanRuleList)
+			{
+				if (rule.Text.size() == 2 && states[static_cast<u8>(rule.Text[0])] == StartState)
+					states[static_cast<u8>(rule.Text[0])] = next++;
+			}
+
+			return states;
+		}
+
+		constexpr std::array<u8, 256> States = BuildStates();
+
+		constexpr u32 CountStates()
+		{
+			u32 count = StartState + 1;
+
+			for (const u8 state : States) count = std::max<u32>(count, state + 1u);
+
+			return count;
+		}
+
+		constexpr u32 StateCount = CountStates();
+
+		struct Transition
+		{
+			ScanAction Action = ScanAction::Error;
+			u8 Next           = StartState;
+			TokenType Type    = TokenType::END_OF_FILE;
+		};
+
+		using TransitionTable = std::array<std::array<Transition, ClassCount>, StateCount>;
+
+		constexpr TransitionTable BuildTransitions()
+		{
+			TransitionTable table = {};
+
+			table[StartState][WhitespaceClass] = {ScanAction::SkipWhitespace};
+			table[StartState][DigitClass]      = {ScanAction::ScanNumber};
+			table[StartState][LetterClass]     = {ScanAction::ScanIdentifier};
+
+			for (const ScanRule& rule : ScanRuleList)
+			{
+				const u8 first = static_cast<u8>(rule.Text[0]);
+
+				if (rule.Text.size() == 1 && States[first] == StartState)
+				{
+					table[StartState][CharClasses[first]] = {rule.Action, StartState, rule.Type};
+				}
+				else if (rule.Text.size() == 1)
+				{
+					// Something longer might follow. If it does not, the single character is the token.
+					for (Transition& transition : table[States[first]])
+						transition = {ScanAction::EmitBefore, StartState, rule.Type};
+				}
+			}
+
+			for (const ScanRule& rule : ScanRuleList)
+			{
+				if (rule.Text.size() != 2)
+					continue;
+
+				const u8 first  = static_cast<u8>(rule.Text[0]);
+				const u8 second = static_cast<u8>(rule.Text[1]);
+
+				table[StartState][CharClasses[first]]     = {ScanAction::Advance, States[first]};
+				table[States[first]][CharClasses[second]] = {rule.Action, StartState, rule.Type};
+			}
+
+			return table;
+		}
+
+		constexpr TransitionTable Transitions = BuildTransitions();
+
+		constexpr bool HasValidRules()
+		{
+			for (const ScanRule& rule : ScanRuleList)
+			{
+				if (rule.Text.empty() || rule.Text.size() > 2)
+					return false;
+			}
+
+			return true;
+		}
+
+		static_assert(HasValidRules(), "Scan rules have to be one or two characters long.");
+		static_assert(Transitions[States['=']][CharClasses['=']].Type == TokenType::EQUAL_EQUAL &&
+		              Transitions[States['=']][CharClasses[' ']].Action == ScanAction::EmitBefore &&
+		              Transitions[States['!']][CharClasses['!']].Action == ScanAction::Error);
+	} // namespace ScanTable
+} // namespace WandeltCore
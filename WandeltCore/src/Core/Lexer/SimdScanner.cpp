@@ -0,0 +1,389 @@
+#include "SimdScanner.hpp"
+
+#include <bit>
+
+#ifdef SW_SIMD_SSE2
+	#include <emmintrin.h>
+#endif
+
+#ifdef SW_SIMD_AVX2
+	#include <immintrin.h>
+	#ifdef SW_COMPILER_MSVC
+		#include <intrin.h>
+	#endif
+#endif
+
+namespace WandeltCore
+{
+	namespace
+	{
+		using ScanFunction = u32 (*)(const char* data, u32 position, u32 size);
+
+		struct ScanFunctions
+		{
+			std::string_view InstructionSet;
+
+			ScanFunction SkipWhitespace;
+			ScanFunction SkipIdentifier;
+			ScanFunction SkipDigits;
+			ScanFunction FindLineEnd;
+			ScanFunction FindBlockCommentEnd;
+		};
+
+		// Scalar
+
+		bool IsWhitespaceChar(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+		}
+
+		bool IsDigitChar(char c)
+		{
+			return c >= '0' && c <= '9';
+		}
+
+		bool IsIdentifierChar(char c)
+		{
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '$' || IsDigitChar(c);
+		}
+
+		u32 SkipWhitespaceScalar(const char* data, u32 position, u32 size)
+		{
+			while (position < size && IsWhitespaceChar(data[position])) ++position;
+
+			return position;
+		}
+
+		u32 SkipIdentifierScalar(const char* data, u32 position, u32 size)
+		{
+			while (position < size && IsIdentifierChar(data[position])) ++position;
+
+			return position;
+		}
+
+		u32 SkipDigitsScalar(const char* data, u32 position, u32 size)
+		{
+			while (position < size && IsDigitChar(data[position])) ++position;
+
+			return position;
+		}
+
+		u32 FindLineEndScalar(const char* data, u32 position, u32 size)
+		{
+			while (position < size && data[position] != '\n') ++position;
+
+			return position;
+		}
+
+		u32 FindBlockCommentEndScalar(const char* data, u32 position, u32 size)
+		{
+			for (; position + 1 < size; ++position)
+			{
+				if (data[position] == '*' && data[position + 1] == '/')
+					return position;
+			}
+
+			return size;
+		}
+
+		[[maybe_unused]] constexpr ScanFunctions ScalarFunctions = {
+		    "Scalar",         SkipWhitespaceScalar, SkipIdentifierScalar, SkipDigitsScalar, FindLineEndScalar,
+		    FindBlockCommentEndScalar};
+
+#ifdef SW_SIMD_SSE2
+		// SSE2, 16 characters at a time.
+		// A run ends at the first zero bit of the class mask, a search ends at the first set bit of the match mask.
+
+		__m128i Load16(const char* data)
+		{
+			return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+		}
+
+		// Bytes in [low, low + count) as an unsigned range check: (c - low) <= count - 1.
+		__m128i InRange16(__m128i chunk, char low, char count)
+		{
+			const __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8(low));
+
+			return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(count - 1)), shifted);
+		}
+
+		__m128i IsWhitespace16(__m128i chunk)
+		{
+			const __m128i spaceOrTab = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+			                                        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+			const __m128i newline    = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+			                                        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+
+			return _mm_or_si128(spaceOrTab, newline);
+		}
+
+		__m128i IsIdentifier16(__m128i chunk)
+		{
+			// Setting bit 5 folds upper case letters onto lower case ones.
+			const __m128i letter = InRange16(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), 'a', 26);
+			const __m128i digit  = InRange16(chunk, '0', 10);
+			const __m128i dollar = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('$'));
+
+			return _mm_or_si128(_mm_or_si128(letter, digit), dollar);
+		}
+
+		u32 RunEnd16(__m128i inClass)
+		{
+			return std::countr_zero(~static_cast<u32>(_mm_movemask_epi8(inClass)));
+		}
+
+		u32 SkipWhitespaceSse2(const char* data, u32 position, u32 size)
+		{
+			for (; position + 16 <= size; position += 16)
+			{
+				const u32 end = RunEnd16(IsWhitespace16(Load16(data + position)));
+				if (end < 16)
+					return position + end;
+			}
+
+			return SkipWhitespaceScalar(data, position, size);
+		}
+
+		u32 SkipIdentifierSse2(const char* data, u32 position, u32 size)
+		{
+			for (; position + 16 <= size; position += 16)
+			{
+				const u32 end = RunEnd16(IsIdentifier16(Load16(data + position)));
+				if (end < 16)
+					return position + end;
+			}
+
+			return SkipIdentifierScalar(data, position, size);
+		}
+
+		u32 SkipDigitsSse2(const char* data, u32 position, u32 size)
+		{
+			for (; position + 16 <= size; position += 16)
+			{
+				const u32 end = RunEnd16(InRange16(Load16(data + position), '0', 10));
+				if (end < 16)
+					return position + end;
+			}
+
+			return SkipDigitsScalar(data, position, size);
+		}
+
+		u32 FindLineEndSse2(const char* data, u32 position, u32 size)
+		{
+			const __m128i newline = _mm_set1_epi8('\n');
+
+			for (; position + 16 <= size; position += 16)
+			{
+				const u32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(Load16(data + position), newline));
+				if (mask)
+					return position + std::countr_zero(mask);
+			}
+
+			return FindLineEndScalar(data, position, size);
+		}
+
+		u32 FindBlockCommentEndSse2(const char* data, u32 position, u32 size)
+		{
+			const __m128i star  = _mm_set1_epi8('*');
+			const __m128i slash = _mm_set1_epi8('/');
+
+			// The second load is shifted by one, so a '*' in the last lane still sees the character after it.
+			for (; position + 17 <= size; position += 16)
+			{
+				const __m128i isStar  = _mm_cmpeq_epi8(Load16(data + position), star);
+				const __m128i isSlash = _mm_cmpeq_epi8(Load16(data + position + 1), slash);
+
+				const u32 mask = _mm_movemask_epi8(_mm_and_si128(isStar, isSlash));
+				if (mask)
+					return position + std::countr_zero(mask);
+			}
+
+			return FindBlockCommentEndScalar(data, position, size);
+		}
+
+		constexpr ScanFunctions Sse2Functions = {"SSE2",         SkipWhitespaceSse2, SkipIdentifierSse2,
+		                                         SkipDigitsSse2, FindLineEndSse2,    FindBlockCommentEndSse2};
+#endif
+
+#ifdef SW_SIMD_AVX2
+		// AVX2, 32 characters at a time. Same structure as the SSE2 paths.
+
+		SW_TARGET_AVX2 __m256i Load32(const char* data)
+		{
+			return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+		}
+
+		SW_TARGET_AVX2 __m256i InRange32(__m256i chunk, char low, char count)
+		{
+			const __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8(low));
+
+			return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(count - 1)), shifted);
+		}
+
+		SW_TARGET_AVX2 __m256i IsWhitespace32(__m256i chunk)
+		{
+			const __m256i spaceOrTab = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+			                                           _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+			const __m256i newline    = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')),
+			                                           _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+
+			return _mm256_or_si256(spaceOrTab, newline);
+		}
+
+		SW_TARGET_AVX2 __m256i IsIdentifier32(__m256i chunk)
+		{
+			const __m256i letter = InRange32(_mm256_or_si256(chunk, _mm256_set1_epi8(0x20)), 'a', 26);
+			const __m256i digit  = InRange32(chunk, '0', 10);
+			const __m256i dollar = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('$'));
+
+			return _mm256_or_si256(_mm256_or_si256(letter, digit), dollar);
+		}
+
+		SW_TARGET_AVX2 u32 RunEnd32(__m256i inClass)
+		{
+			return std::countr_zero(~static_cast<u32>(_mm256_movemask_epi8(inClass)));
+		}
+
+		SW_TARGET_AVX2 u32 SkipWhitespaceAvx2(const char* data, u32 position, u32 size)
+		{
+			for (; position + 32 <= size; position += 32)
+			{
+				const u32 end = RunEnd32(IsWhitespace32(Load32(data + position)));
+				if (end < 32)
+					return position + end;
+			}
+
+			return SkipWhitespaceSse2(data, position, size);
+		}
+
+		SW_TARGET_AVX2 u32 SkipIdentifierAvx2(const char* data, u32 position, u32 size)
+		{
+			for (; position + 32 <= size; position += 32)
+			{
+				const u32 end = RunEnd32(IsIdentifier32(Load32(data + position)));
+				if (end < 32)
+					return position + end;
+			}
+
+			return SkipIdentifierSse2(data, position, size);
+		}
+
+		SW_TARGET_AVX2 u32 SkipDigitsAvx2(const char* data, u32 position, u32 size)
+		{
+			for (; position + 32 <= size; position += 32)
+			{
+				const u32 end = RunEnd32(InRange32(Load32(data + position), '0', 10));
+				if (end < 32)
+					return position + end;
+			}
+
+			return SkipDigitsSse2(data, position, size);
+		}
+
+		SW_TARGET_AVX2 u32 FindLineEndAvx2(const char* data, u32 position, u32 size)
+		{
+			const __m256i newline = _mm256_set1_epi8('\n');
+
+			for (; position + 32 <= size; position += 32)
+			{
+				const u32 mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(Load32(data + position), newline));
+				if (mask)
+					return position + std::countr_zero(mask);
+			}
+
+			return FindLineEndSse2(data, position, size);
+		}
+
+		SW_TARGET_AVX2 u32 FindBlockCommentEndAvx2(const char* data, u32 position, u32 size)
+		{
+			const __m256i star  = _mm256_set1_epi8('*');
+			const __m256i slash = _mm256_set1_epi8('/');
+
+			for (; position + 33 <= size; position += 32)
+			{
+				const __m256i isStar  = _mm256_cmpeq_epi8(Load32(data + position), star);
+				const __m256i isSlash = _mm256_cmpeq_epi8(Load32(data + position + 1), slash);
+
+				const u32 mask = _mm256_movemask_epi8(_mm256_and_si256(isStar, isSlash));
+				if (mask)
+					return position + std::countr_zero(mask);
+			}
+
+			return FindBlockCommentEndSse2(data, position, size);
+		}
+
+		constexpr ScanFunctions Avx2Functions = {"AVX2",         SkipWhitespaceAvx2, SkipIdentifierAvx2,
+		                                         SkipDigitsAvx2, FindLineEndAvx2,    FindBlockCommentEndAvx2};
+
+		bool IsAvx2Supported()
+		{
+	#ifdef SW_COMPILER_MSVC
+			int info[4];
+
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			// The OS has to save the YMM registers on context switches (OSXSAVE + AVX, XCR0 bits 1 and 2).
+			__cpuid(info, 1);
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+	#else
+			// Selection runs during static initialization, possibly before the CPU model is initialized.
+			__builtin_cpu_init();
+
+			return __builtin_cpu_supports("avx2");
+	#endif
+		}
+#endif
+
+		ScanFunctions SelectScanFunctions()
+		{
+#ifdef SW_SIMD_AVX2
+			if (IsAvx2Supported())
+				return Avx2Functions;
+#endif
+
+#ifdef SW_SIMD_SSE2
+			return Sse2Functions;
+#else
+			return ScalarFunctions;
+#endif
+		}
+
+		const ScanFunctions s_Functions = SelectScanFunctions();
+	} // namespace
+
+	u32 SimdScanner::SkipWhitespace(std::string_view source, u32 position)
+	{
+		return s_Functions.SkipWhitespace(source.data(), position, static_cast<u32>(source.size()));
+	}
+
+	u32 SimdScanner::SkipIdentifier(std::string_view source, u32 position)
+	{
+		return s_Functions.SkipIdentifier(source.data(), position, static_cast<u32>(source.size()));
+	}
+
+	u32 SimdScanner::SkipDigits(std::string_view source, u32 position)
+	{
+		return s_Functions.SkipDigits(source.data(), position, static_cast<u32>(source.size()));
+	}
+
+	u32 SimdScanner::FindLineEnd(std::string_view source, u32 position)
+	{
+		return s_Functions.FindLineEnd(source.data(), position, static_cast<u32>(source.size()));
+	}
+
+	u32 SimdScanner::FindBlockCommentEnd(std::string_view source, u32 position)
+	{
+		return s_Functions.FindBlockCommentEnd(source.data(), position, static_cast<u32>(source.size()));
+	}
+
+	std::string_view SimdScanner::GetInstructionSet()
+	{
+		return s_Functions.InstructionSet;
+	}
+} // namespace WandeltCore
@@ -0,0 +1,38 @@
+/**
+ * @file SimdScanner.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+namespace WandeltCore
+{
+	// Vectorized scanning of the character runs the Lexer skips over. Uses AVX2 when the CPU supports it,
+	// SSE2 otherwise and a scalar loop for the tail of the buffer and on other architectures.
+	// Every function scans forward from `position` and returns the index of the first character
+	// that ends the run, or the size of the source if the run reaches the end of it.
+	class SimdScanner
+	{
+	public:
+		// Skip a run of ' ', '\t', '\r' and '\n'.
+		static u32 SkipWhitespace(std::string_view source, u32 position);
+
+		// Skip a run of identifier characters (a-z, A-Z, $, 0-9).
+		static u32 SkipIdentifier(std::string_view source, u32 position);
+
+		// Skip a run of digits (0-9).
+		static u32 SkipDigits(std::string_view source, u32 position);
+
+		// Find the next '\n', the end of a line comment.
+		static u32 FindLineEnd(std::string_view source, u32 position);
+
+		// Find the next "*/", the end of a block comment. Returns the index of the '*'.
+		static u32 FindBlockCommentEnd(std::string_view source, u32 position);
+
+		// The name of the instruction set the scanner dispatched to, for logging.
+		static std::string_view GetInstructionSet();
+	};
+} // namespace WandeltCore
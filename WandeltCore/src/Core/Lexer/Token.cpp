@@ -1,7 +1,25 @@
 #include "Token.hpp"
 
+#include "Lexer.hpp"
+
 namespace WandeltCore
 {
+	u32 Token::GetLength() const
+	{
+		switch (Type)
+		{
+		case TokenType::NUMBER:
+			return Lexer::SkipNumberLiteral(SourceManager::GetSource(FileID), Offset) - Offset;
+		case TokenType::VARIABLE_IDENTIFIER:
+		case TokenType::FUNCTION_IDENTIFIER:
+			return static_cast<u32>(StringInterner::Get().GetString(Symbol).size());
+		case TokenType::END_OF_FILE:
+			return 0;
+		default:
+			return static_cast<u32>(TokenTypeToStringRepresentation(Type).size());
+		}
+	}
+
 	std::string_view TokenTypeToString(TokenType type)
 	{
 		switch (type)
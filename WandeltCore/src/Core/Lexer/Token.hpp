@@ -55,24 +55,138 @@ namespace WandeltCore
 		END_OF_FILE,
 	};
 
+	// Whether the token is a comparison operator. The comparisons come one after the other.
+	constexpr bool IsComparisonOperator(TokenType type)
+	{
+		return type >= TokenType::EQUAL_EQUAL && type <= TokenType::GREATER_EQUAL;
+	}
+
 	// Returns the name of the token type. e.g. TokenType::NUMBER -> "NUMBER"
 	std::string_view TokenTypeToString(TokenType type);
 
 	// Returns the string representation of the token type. e.g. TokenType::SEMICOLON -> ";"
 	std::string_view TokenTypeToStringRepresentation(TokenType type);
 
+	// Compact POD token. Neither the text nor the length of the token is stored, both are resolved on demand.
 	struct Token
 	{
-		TokenType Type;
-		std::optional<std::string> Lexeme = std::nullopt;
-		SourceLocation Location;
+		u32 Offset;     // Byte offset of the first character of the token in its file
+		u16 FileID;     // Id of the file in the SourceManager
+		TokenType Type; // Type of the token
+
+		union
+		{
+			u64 Value;       // Decoded value of NUMBER tokens
+			SymbolID Symbol; // Interned name of VARIABLE_IDENTIFIER and FUNCTION_IDENTIFIER tokens
+		};
+
+		SourceLocation GetLocation() const { return {FileID, Offset}; }
 
-		// Check if the token has a lexeme.
-		bool HasLexeme() const { return Lexeme.has_value(); }
+		bool IsIdentifier() const
+		{
+			return Type == TokenType::VARIABLE_IDENTIFIER || Type == TokenType::FUNCTION_IDENTIFIER;
+		}
+
+		// Check if the token has a lexeme, meaning its text is not implied by its type.
+		bool HasLexeme() const
+		{
+			return Type == TokenType::NUMBER || Type == TokenType::VARIABLE_IDENTIFIER ||
+			       Type == TokenType::FUNCTION_IDENTIFIER;
+		}
+
+		// Length of the token in bytes. Derived from the type, the interned name or by rescanning the literal.
+		u32 GetLength() const;
+
+		// The text of the token, a view into the source buffer.
+		std::string_view GetLexeme() const { return SourceManager::GetSource(FileID).substr(Offset, GetLength()); }
 	};
 
-	static const std::unordered_map<std::string_view, TokenType> Keywords = {{"let", TokenType::LET_KEYWORD},
-	                                                                         {"return", TokenType::RETURN_KEYWORD},
-	                                                                         {"if", TokenType::IF_KEYWORD},
-	                                                                         {"else", TokenType::ELSE_KEYWORD}};
+	static_assert(sizeof(Token) == 16, "Token should stay a compact POD.");
+	static_assert(std::is_trivially_copyable_v<Token>, "Token should stay a compact POD.");
+
+	struct Keyword
+	{
+		std::string_view Text;
+		TokenType Type;
+	};
+
+	// Every keyword of the language. The keyword lookup table is generated from this list at compile time,
+	// adding a keyword only takes a new entry here.
+	constexpr auto KeywordList = std::to_array<Keyword>({
+	    {"let", TokenType::LET_KEYWORD},
+	    {"return", TokenType::RETURN_KEYWORD},
+	    {"if", TokenType::IF_KEYWORD},
+	    {"else", TokenType::ELSE_KEYWORD},
+	});
+
+	namespace KeywordTable
+	{
+		// At least twice as many slots as keywords, rounded to a power of two so the hash can be masked.
+		constexpr u32 Size = std::bit_ceil(static_cast<u32>(KeywordList.size() * 2));
+
+		constexpr u32 Hash(std::string_view text, u32 seed)
+		{
+			return (static_cast<u8>(text.front()) * seed + static_cast<u8>(text.back()) +
+			        static_cast<u32>(text.size())) &
+			       (Size - 1);
+		}
+
+		// Find the first seed that maps every keyword to its own slot.
+		constexpr u32 FindSeed()
+		{
+			for (u32 seed = 1; seed < 1024; ++seed)
+			{
+				std::array<bool, Size> taken = {};
+				bool isPerfect               = true;
+
+				for (const Keyword& keyword : KeywordList)
+				{
+					const u32 slot = Hash(keyword.Text, seed);
+
+					if (taken[slot])
+					{
+						isPerfect = false;
+						break;
+					}
+
+					taken[slot] = true;
+				}
+
+				if (isPerfect)
+					return seed;
+			}
+
+			return 0;
+		}
+
+		constexpr u32 Seed = FindSeed();
+		static_assert(Seed != 0, "No perfect hash seed found for the keyword list, widen the search or the table.");
+
+		constexpr std::array<Keyword, Size> Build()
+		{
+			std::array<Keyword, Size> table = {};
+
+			for (const Keyword& keyword : KeywordList) table[Hash(keyword.Text, Seed)] = keyword;
+
+			return table;
+		}
+
+		constexpr std::array<Keyword, Size> Slots = Build();
+	} // namespace KeywordTable
+
+	// Look up the keyword spelled by the given text. One hash and one compare, no allocation.
+	constexpr std::optional<TokenType> FindKeyword(std::string_view text)
+	{
+		if (text.empty())
+			return std::nullopt;
+
+		const Keyword& slot = KeywordTable::Slots[KeywordTable::Hash(text, KeywordTable::Seed)];
+
+		if (slot.Text != text)
+			return std::nullopt;
+
+		return slot.Type;
+	}
+
+	static_assert(FindKeyword("return") == TokenType::RETURN_KEYWORD && !FindKeyword("println").has_value());
 } // namespace WandeltCore
@@ -0,0 +1,89 @@
+#include "TokenStream.hpp"
+
+#include "Lexer.hpp"
+
+namespace WandeltCore
+{
+	TokenStream::TokenStream(std::span<const Token> tokens) : m_Tokens(tokens)
+	{
+		ASSERT(!m_Tokens.empty(), "Token stream needs at least one token.");
+
+		m_EndOfFile       = m_Tokens.back();
+		m_EndOfFile.Type  = TokenType::END_OF_FILE;
+		m_EndOfFile.Value = 0;
+
+		m_End = static_cast<u32>(m_Tokens.size());
+	}
+
+	TokenStream::TokenStream(Lexer& lexer) : m_End(std::numeric_limits<u32>::max()), m_Lexer(&lexer)
+	{
+		Fill(1);
+	}
+
+	const Token& TokenStream::GetPrevious() const
+	{
+		ASSERT(m_Current > 0, "There is no token before the first one.");
+
+		return Get(m_Current - 1);
+	}
+
+	const Token& TokenStream::GetCurrent() const
+	{
+		return Get(m_Current);
+	}
+
+	const Token& TokenStream::GetNext() const
+	{
+		return Get(m_Current + 1);
+	}
+
+	void TokenStream::Advance()
+	{
+		++m_Current;
+
+		if (IsStreaming() && m_Current + 1 < m_End)
+			Fill(m_Current + 1); // Keep the next token available for GetNext
+	}
+
+	void TokenStream::SkipToEnd()
+	{
+		if (m_Current >= m_End)
+			return;
+
+		m_EndOfFile       = GetCurrent();
+		m_EndOfFile.Type  = TokenType::END_OF_FILE;
+		m_EndOfFile.Value = 0;
+
+		m_End = m_Current;
+	}
+
+	u32 TokenStream::GetLexerErrorCount() const
+	{
+		return IsStreaming() ? m_Lexer->GetErrorCount() : 0;
+	}
+
+	const Token& TokenStream::Get(u32 index) const
+	{
+		if (index >= m_End)
+			return m_EndOfFile;
+
+		if (IsStreaming())
+		{
+			// Everything up to the next token is pulled on Advance, and the window covers the previous one.
+			ASSERT(index < m_Pulled && index + WindowSize >= m_Pulled, "Token {} is outside of the window.", index);
+
+			return m_Window[index & (WindowSize - 1)];
+		}
+
+		return m_Tokens[index];
+	}
+
+	void TokenStream::Fill(u32 index)
+	{
+		while (m_Pulled <= index)
+		{
+			m_Window[m_Pulled & (WindowSize - 1)] = m_Lexer->NextToken();
+			++m_Pulled;
+		}
+	}
+} // namespace WandeltCore
@@ -0,0 +1,69 @@
+/**
+ * @file TokenStream.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+#include "Token.hpp"
+
+namespace WandeltCore
+{
+	class Lexer;
+
+	// The tokens the Parser reads, one previous, the current and one next token at a time.
+	// Either backed by tokens lexed up front with Lexer::Lex, or pulled from the Lexer on demand into
+	// a small ring buffer, in which case only a constant number of tokens is ever in memory.
+	class TokenStream
+	{
+	public:
+		// Stream over tokens lexed up front, without copying them. The tokens have to outlive the stream.
+		// Tokens that do not end with END_OF_FILE, like a chunk of a file, end in one at their last token.
+		explicit TokenStream(std::span<const Token> tokens);
+
+		// Stream that lexes on demand.
+		explicit TokenStream(Lexer& lexer);
+
+		const Token& GetPrevious() const;
+		const Token& GetCurrent() const;
+		const Token& GetNext() const;
+
+		// Move to the next token. Past the end the stream keeps returning END_OF_FILE.
+		void Advance();
+
+		// End the stream at the current token, from then on it returns END_OF_FILE without lexing any further.
+		void SkipToEnd();
+
+		// Errors the lexer reported so far when streaming, errors of tokens lexed up front are known before.
+		u32 GetLexerErrorCount() const;
+
+		bool IsStreaming() const { return m_Lexer != nullptr; }
+
+		// All tokens of a stream over tokens lexed up front, empty when streaming.
+		std::span<const Token> GetTokens() const { return m_Tokens; }
+
+	private:
+		const Token& Get(u32 index) const;
+
+		// Pull tokens from the lexer until the one at the given index is available.
+		void Fill(u32 index);
+
+	private:
+		// Previous, current and next have to fit, rounded up to a power of two for masking.
+		static constexpr u32 WindowSize = 4;
+		static_assert(std::has_single_bit(WindowSize), "Window size must be a power of two.");
+
+		std::span<const Token> m_Tokens; // Tokens lexed up front, empty when streaming
+		Token m_EndOfFile{};             // Returned past the end
+		u32 m_End = 0;                   // Index of the first token past the end
+
+		Lexer* m_Lexer = nullptr;                 // The lexer tokens are pulled from when streaming
+		std::array<Token, WindowSize> m_Window{}; // Ring buffer of the most recently pulled tokens
+		u32 m_Pulled = 0;                         // Number of tokens pulled from the lexer so far
+
+		u32 m_Current = 0; // Index of the current token
+	};
+} // namespace WandeltCore
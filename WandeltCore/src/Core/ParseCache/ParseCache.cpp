@@ -0,0 +1,141 @@
+#include "ParseCache.hpp"
+
+#include <format>
+#include <random>
+
+#include "Core/FileSystem/FileSystem.hpp"
+
+namespace WandeltCore
+{
+	namespace
+	{
+		// Followed by the SourceSize bytes of the source and the serialized AST.
+		struct EntryHeader
+		{
+			u64 SourceHash;
+			u64 SourceSize;
+			u32 FormatVersion;
+			u32 ShareExpressions; // 1 for ASTs lowered with equal expressions shared
+		};
+	} // namespace
+
+	ParseCache::ParseCache(std::filesystem::path directory, bool shareExpressions)
+	    : m_Directory(std::move(directory)), m_ShareExpressions(shareExpressions)
+	{
+	}
+
+	std::optional<FlatAst> ParseCache::Load(u16 fileID) const
+	{
+		if (!IsEnabled())
+			return std::nullopt;
+
+		const std::string_view source = SourceManager::GetSource(fileID);
+		const u64 hash                = HashSource(source);
+		const u32 version             = FlatAst::GetSerializedVersion();
+
+		const std::filesystem::path path = GetEntryPath(hash, version);
+
+		if (!FileSystem::Exists(path))
+			return std::nullopt;
+
+		// Mapped, so the entry is read straight from the page cache in the one pass that deserializes it.
+		const MappedFile file       = FileSystem::MapFile(path);
+		const std::string_view data = file.GetView();
+
+		EntryHeader header;
+
+		if (data.size() < sizeof(header))
+			return std::nullopt;
+
+		std::memcpy(&header, data.data(), sizeof(header));
+
+		if (header.SourceHash != hash || header.SourceSize != source.size() || header.FormatVersion != version ||
+		    header.ShareExpressions != u32(m_ShareExpressions))
+			return std::nullopt;
+
+		// Only the source itself tells apart two sources of the same hash and size.
+		if (data.substr(sizeof(header), source.size()) != source)
+			return std::nullopt;
+
+		return FlatAst::Deserialize(data.substr(sizeof(header) + source.size()), fileID);
+	}
+
+	void ParseCache::Store(u16 fileID, const FlatAst& ast) const
+	{
+		if (!IsEnabled())
+			return;
+
+		const std::string_view source = SourceManager::GetSource(fileID);
+		const EntryHeader header      = {HashSource(source), source.size(), FlatAst::GetSerializedVersion(),
+		                                 u32(m_ShareExpressions)};
+
+		std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+		data.append(source);
+		ast.Serialize(data);
+
+		std::error_code error;
+		std::filesystem::create_directories(m_Directory, error);
+
+		// Write to a temporary file first, so a compiler reading the cache at the same time never sees half an entry.
+		// The name is random, so compilers storing the same entry at the same time do not write into one file.
+		const std::filesystem::path path = GetEntryPath(header.SourceHash, header.FormatVersion);
+
+		std::random_device random;
+		const u64 suffix = u64(random()) << 32 | random();
+
+		const std::filesystem::path temporaryPath = std::format("{}.{:016x}.tmp", path.string(), suffix);
+
+		if (error || !FileSystem::WriteFile(temporaryPath, data))
+		{
+			SYSTEM_WARN("Could not write the parse cache entry {}.", path.string());
+
+			std::filesystem::remove(temporaryPath, error);
+			return;
+		}
+
+		std::filesystem::rename(temporaryPath, path, error);
+
+		if (error)
+		{
+			SYSTEM_WARN("Could not write the parse cache entry {}.", path.string());
+
+			std::filesystem::remove(temporaryPath, error);
+		}
+	}
+
+	u64 ParseCache::HashSource(std::string_view source)
+	{
+		// Multiply-xorshift over 8 bytes at a time like the interner, but keeping all 64 bits.
+		constexpr u64 multiplier = 0x9E3779B97F4A7C15ull;
+
+		const char* data = source.data();
+		size_t size      = source.size();
+
+		u64 hash = size * multiplier;
+
+		for (; size >= 8; data += 8, size -= 8)
+		{
+			u64 word;
+			std::memcpy(&word, data, 8);
+
+			hash = (hash ^ word) * multiplier;
+			hash ^= hash >> 32;
+		}
+
+		if (size > 0)
+		{
+			u64 word = 0;
+			std::memcpy(&word, data, size);
+
+			hash = (hash ^ word) * multiplier;
+			hash ^= hash >> 32;
+		}
+
+		return hash;
+	}
+
+	std::filesystem::path ParseCache::GetEntryPath(u64 hash, u32 version) const
+	{
+		return m_Directory / std::format("{:016x}-v{}{}.ast", hash, version, m_ShareExpressions ? "-shared" : "");
+	}
+} // namespace WandeltCore
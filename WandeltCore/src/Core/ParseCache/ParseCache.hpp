@@ -0,0 +1,44 @@
+/**
+ * @file ParseCache.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+#include "Core/AST/FlatAst.hpp"
+
+namespace WandeltCore
+{
+	// Parsed ASTs on disk, keyed by a hash of the source they were parsed from, the version of the AST format and
+	// whether equal expressions were lowered to shared nodes. An entry starts with its key and a copy of the source,
+	// which is compared with the current source on load, so stale entries and hash collisions are misses. The
+	// serialized AST follows.
+	class ParseCache
+	{
+	public:
+		// An empty directory disables the cache. The directory is created on the first store. Only ASTs lowered the
+		// same way, with or without shared expressions, are loaded.
+		ParseCache(std::filesystem::path directory, bool shareExpressions);
+
+		bool IsEnabled() const { return !m_Directory.empty(); }
+
+		// The AST parsed from the current contents of the file, if the cache has an entry for them.
+		std::optional<FlatAst> Load(u16 fileID) const;
+
+		// Store the AST parsed from the current contents of the file. Only ASTs without errors belong in here.
+		// Failing to write is not an error, the source just gets parsed again next time.
+		void Store(u16 fileID, const FlatAst& ast) const;
+
+		static u64 HashSource(std::string_view source);
+
+	private:
+		std::filesystem::path GetEntryPath(u64 hash, u32 version) const;
+
+	private:
+		std::filesystem::path m_Directory;
+		bool m_ShareExpressions = false; // Whether the ASTs are lowered with equal expressions shared
+	};
+} // namespace WandeltCore
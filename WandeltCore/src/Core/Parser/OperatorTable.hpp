@@ -0,0 +1,74 @@
+/**
+ * @file OperatorTable.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+#include "Core/Lexer/Token.hpp"
+
+namespace WandeltCore
+{
+	enum class Associativity : u8
+	{
+		Left,  // a - b - c is (a - b) - c
+		Right, // a ** b ** c is a ** (b ** c)
+	};
+
+	struct OperatorInfo
+	{
+		i32 Precedence          = -1;                  // Higher binds tighter, negative if no such operator
+		Associativity Direction = Associativity::Left; // Which side operators of equal precedence group to
+
+		constexpr bool IsOperator() const { return Precedence >= 0; }
+	};
+
+	// Precedence and associativity of the binary and prefix operators, indexed by token type.
+	// The parser reads everything about operators from here, so changing how they bind is a table edit.
+	class OperatorTable
+	{
+	public:
+		constexpr void SetBinary(TokenType type, i32 precedence, Associativity associativity = Associativity::Left)
+		{
+			m_Binary[static_cast<u8>(type)] = {precedence, associativity};
+		}
+
+		constexpr void SetPrefix(TokenType type, i32 precedence)
+		{
+			m_Prefix[static_cast<u8>(type)] = {precedence, Associativity::Right};
+		}
+
+		constexpr const OperatorInfo& GetBinary(TokenType type) const { return m_Binary[static_cast<u8>(type)]; }
+		constexpr const OperatorInfo& GetPrefix(TokenType type) const { return m_Prefix[static_cast<u8>(type)]; }
+
+		// The operators of the language. Prefix minus binds tightest, so -2 ** 2 is (-2) ** 2.
+		static constexpr OperatorTable Default()
+		{
+			OperatorTable table;
+
+			table.SetPrefix(TokenType::MINUS, 8);
+
+			table.SetBinary(TokenType::DOUBLE_STAR, 7, Associativity::Right);
+			table.SetBinary(TokenType::PERCENT, 6);
+			table.SetBinary(TokenType::STAR, 5);
+			table.SetBinary(TokenType::SLASH, 5);
+			table.SetBinary(TokenType::PLUS, 4);
+			table.SetBinary(TokenType::MINUS, 4);
+			table.SetBinary(TokenType::LESS, 3);
+			table.SetBinary(TokenType::LESS_EQUAL, 3);
+			table.SetBinary(TokenType::GREATER, 3);
+			table.SetBinary(TokenType::GREATER_EQUAL, 3);
+			table.SetBinary(TokenType::EQUAL_EQUAL, 2);
+			table.SetBinary(TokenType::BANG_EQUAL, 2);
+
+			return table;
+		}
+
+	private:
+		std::array<OperatorInfo, 256> m_Binary{};
+		std::array<OperatorInfo, 256> m_Prefix{};
+	};
+} // namespace WandeltCore
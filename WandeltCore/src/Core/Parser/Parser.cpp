@@ -1,293 +1,776 @@
 #include "Parser.hpp"
 
+#include <algorithm>
 #include <iostream>
 
+#include "Core/AST/FlatAst.hpp"
+#include "Core/Lexer/Lexer.hpp"
+#include "Core/ThreadPool/ThreadPool.hpp"
+
 namespace WandeltCore
 {
-	Parser::Parser(const std::vector<Token>& tokens) : m_Tokens(tokens)
+	Parser::Parser(TokenStream tokens, const OperatorTable& operators)
+	    : m_Tokens(std::move(tokens)), m_Operators(operators)
 	{
 	}
 
-	Parser::~Parser()
+	void Parser::Parse()
 	{
-		for (Statement* statement : m_Statements) delete statement;
+		if (IsParsedInParallel())
+			ParseParallel();
+		else
+			ParseSerial();
+
+		m_ParsedBytes = m_Ast.Arena.GetUsedBytes();
 	}
 
-	void Parser::Parse()
+	bool Parser::IsParsedInParallel() const
 	{
+		return !m_Tokens.IsStreaming() && m_Tokens.GetTokens().size() >= ParallelThreshold &&
+		       ThreadPool::Get().GetThreadCount() > 1;
+	}
+
+	std::vector<u32> Parser::FindStatementBoundaries(std::span<const Token> tokens, u32 chunkCount)
+	{
+		const u32 size = static_cast<u32>(tokens.size());
+
+		std::vector<u32> boundaries = {0};
+
+		u32 target = static_cast<u32>(u64(size) / chunkCount); // The next chunk starts at the first boundary after it
+		i32 depth  = 0;                                        // Nesting depth of the braces
+
+		for (u32 i = 0; i + 1 < size && boundaries.size() < chunkCount; i++)
+		{
+			const TokenType type = tokens[i].Type;
+
+			if (type == TokenType::LEFT_BRACE)
+				depth++;
+			else if (type == TokenType::RIGHT_BRACE)
+				depth--;
+
+			if (depth != 0 || i + 1 < target)
+				continue;
+
+			// A scope followed by an else belongs to the same if statement.
+			const bool endsScope = type == TokenType::RIGHT_BRACE && tokens[i + 1].Type != TokenType::ELSE_KEYWORD;
+
+			if (type != TokenType::SEMICOLON && !endsScope)
+				continue;
+
+			boundaries.push_back(i + 1);
+			target = static_cast<u32>(u64(size) * boundaries.size() / chunkCount);
+		}
+
+		boundaries.push_back(size);
+
+		return boundaries;
+	}
+
+	void Parser::ParseSerial()
+	{
+		m_FileID = GetCurrentToken().FileID;
+
+		while (!IsAtEnd()) AddTopLevelEntry(ParseTopLevelEntry());
+	}
+
+	void Parser::ParseParallel()
+	{
+		// Chunks of at least 64k tokens, so the work per chunk outweighs the scheduling.
+		constexpr u32 minChunkSize = 64 * 1024;
+
+		ThreadPool& pool = ThreadPool::Get();
+
+		const std::span<const Token> tokens = m_Tokens.GetTokens();
+
+		const u32 chunkCount =
+		    std::max(std::min(pool.GetThreadCount(), static_cast<u32>(tokens.size() / minChunkSize)), 1u);
+
+		const std::vector<u32> boundaries = FindStatementBoundaries(tokens, chunkCount);
+
+		// Every chunk is parsed into an arena of its own, nothing is shared between the threads.
+		std::vector<Ast> chunkAsts(boundaries.size() - 1);
+		std::vector<std::vector<TopLevelEntry>> chunkEntries(boundaries.size() - 1);
+		std::vector<u8> chunkValid(boundaries.size() - 1, false);
+
+		pool.ParallelFor(static_cast<u32>(chunkAsts.size()), [&](u32 chunk) {
+			const std::span<const Token> chunkTokens =
+			    tokens.subspan(boundaries[chunk], boundaries[chunk + 1] - boundaries[chunk]);
+
+			Parser parser(TokenStream(chunkTokens), m_Operators);
+			parser.m_ReportErrors = false;
+
+			parser.ParseSerial();
+
+			chunkEntries[chunk] = std::move(parser.m_Entries);
+			chunkAsts[chunk]    = parser.TakeAst();
+			chunkValid[chunk]   = parser.m_IsValid;
+		});
+
+		if (std::find(chunkValid.begin(), chunkValid.end(), false) != chunkValid.end())
+		{
+			// Parse serially again, so errors are reported exactly as without chunking.
+			ParseSerial();
+
+			return;
+		}
+
+		m_FileID = tokens.front().FileID;
+
+		for (u32 chunk = 0; chunk < chunkAsts.size(); chunk++)
+		{
+			m_Ast.Arena.Adopt(std::move(chunkAsts[chunk].Arena));
+
+			for (const TopLevelEntry& entry : chunkEntries[chunk]) AddTopLevelEntry(entry);
+		}
+	}
+
+	void Parser::ReparseAll()
+	{
+		Lexer lexer(m_FileID, 0);
+		TokenStream tokens(lexer);
+
+		std::swap(m_Tokens, tokens);
+
+		m_Ast              = Ast();
+		m_IsValid          = true;
+		m_ErrorCount       = 0;
+		m_FailedEntryCount = 0;
+		m_Entries.clear();
+
+		ParseSerial();
+
+		// Reaching the error limit skipped the rest of the file, so the next edit parses all of it again too.
+		m_NeedsFullReparse = !lexer.IsValid() || HasReachedErrorLimit();
+		m_IsValid          = m_IsValid && lexer.IsValid();
+		m_ParsedBytes      = m_Ast.Arena.GetUsedBytes();
+
+		std::swap(m_Tokens, tokens);
+	}
+
+	void Parser::Reparse(const SourceEdit& edit)
+	{
+		ASSERT(m_FileID != InvalidFileID, "Reparse needs a parsed file.");
+
+		SourceManager::ApplyEdit(m_FileID, edit);
+
+		// Replaced statements stay in the arena. Once they take up as much of it as the last full parse did, the
+		// file is parsed into a fresh arena, which costs about as much as was allocated since.
+		const bool isArenaFull = m_Ast.Arena.GetUsedBytes() >= 2 * m_ParsedBytes + MinReplacedBytes;
+
+		if (m_NeedsFullReparse || m_Entries.empty() || isArenaFull)
+		{
+			ReparseAll();
+
+			return;
+		}
+
+		// The error limit applies to each edit. The lexer below is new, so its errors start at zero too.
+		m_ErrorCount = 0;
+
+		const i64 delta        = i64(edit.Text.size()) - edit.RemovedLength;
+		const u32 oldEditEnd   = edit.Offset + edit.RemovedLength;
+		const u32 newEditEnd   = edit.Offset + static_cast<u32>(edit.Text.size());
+		const u32 lastUnedited = edit.Offset > 0 ? edit.Offset - 1 : 0;
+
+		// Start at the entry the character in front of the edit belongs to, an edit can extend the token it follows.
+		const auto firstAfter =
+		    std::upper_bound(m_Entries.begin(), m_Entries.end(), lastUnedited,
+		                     [](u32 offset, const TopLevelEntry& entry) { return offset < entry.Begin; });
+
+		const size_t first = firstAfter == m_Entries.begin() ? 0 : firstAfter - m_Entries.begin() - 1;
+
+		// The first entry also owns the whitespace and comments at the start of the file.
+		Lexer lexer(m_FileID, first == 0 ? 0 : m_Entries[first].Begin);
+		TokenStream tokens(lexer);
+
+		std::swap(m_Tokens, tokens);
+
+		std::vector<TopLevelEntry> entries;
+
+		size_t reused  = first + 1; // The old entry the reparsed ones may line up with next
+		bool isLinedUp = false;
+
 		while (!IsAtEnd())
 		{
-			const TokenType type = GetCurrentToken().Type;
+			const u32 offset = GetCurrentToken().Offset;
 
-			if (type == TokenType::IF_KEYWORD)
+			// Behind the edit, a token that starts where an old entry started begins the same tokens as before,
+			// and the top level loop parses them into the same entries.
+			if (offset >= newEditEnd)
 			{
-				// Parse if statement
-				Statement* ifStatement = ParseIfStatement();
-				if (!ifStatement)
-				{
-					SynchronizeAfterError();
-					continue;
-				}
+				while (reused < m_Entries.size() && m_Entries[reused].Begin + delta < offset) reused++;
 
-				m_Statements.push_back(ifStatement);
+				isLinedUp = reused < m_Entries.size() && m_Entries[reused].Begin >= oldEditEnd &&
+				            m_Entries[reused].Begin + delta == offset;
 
-				continue;
+				if (isLinedUp)
+					break;
 			}
-			else if (type == TokenType::RETURN_KEYWORD)
+
+			entries.push_back(ParseTopLevelEntry());
+		}
+
+		std::swap(m_Tokens, tokens);
+
+		// Replace the reparsed entries and move the reused ones behind them.
+		const size_t last = isLinedUp ? reused : m_Entries.size();
+
+		for (size_t i = first; i < last; i++) m_FailedEntryCount -= m_Entries[i].HasErrors;
+
+		for (size_t i = last; i < m_Entries.size(); i++)
+		{
+			m_Entries[i].Begin += static_cast<u32>(delta);
+			m_Entries[i].PendingShift += static_cast<i32>(delta);
+		}
+
+		m_Entries.erase(m_Entries.begin() + first, m_Entries.begin() + last);
+		m_Entries.insert(m_Entries.begin() + first, entries.begin(), entries.end());
+
+		m_Ast.Statements.clear();
+
+		for (const TopLevelEntry& entry : m_Entries)
+		{
+			if (entry.Node)
+				m_Ast.Statements.push_back(entry.Node);
+		}
+
+		for (const TopLevelEntry& entry : entries) m_FailedEntryCount += entry.HasErrors;
+
+		// Lexing errors are not tracked per entry, the next edit can only tell they are gone by relexing everything.
+		// Reaching the error limit dropped the entries behind the reparsed ones.
+		m_NeedsFullReparse = !lexer.IsValid() || HasReachedErrorLimit();
+		m_IsValid          = m_FailedEntryCount == 0 && !m_NeedsFullReparse;
+
+#ifdef SW_DEBUG_BUILD
+		if (!m_NeedsFullReparse)
+			CheckReparse();
+#endif
+	}
+
+	void Parser::CheckReparse()
+	{
+		Lexer lexer(m_FileID, 0);
+
+		Parser parser(TokenStream(lexer), m_Operators);
+		parser.m_ReportErrors = false;
+		parser.ParseSerial();
+
+		ASSERT(parser.m_IsValid == m_IsValid, "Reparsing found the file {}, parsing all of it {}",
+		       m_IsValid ? "valid" : "invalid", parser.m_IsValid ? "valid" : "invalid");
+
+		// The serialized flat ASTs hold every node with its location.
+		std::string reparsed;
+		std::string parsed;
+
+		FlatAst::Lower(GetStatements(), false).Serialize(reparsed);
+		FlatAst::Lower(parser.GetStatements(), false).Serialize(parsed);
+
+		ASSERT(reparsed == parsed, "Reparsing gave another AST than parsing all of the file");
+	}
+
+	const std::vector<Statement*>& Parser::GetStatements()
+	{
+		ApplyPendingShifts();
+
+		return m_Ast.Statements;
+	}
+
+	Ast Parser::TakeAst()
+	{
+		ApplyPendingShifts();
+
+		// The entries point into the AST, they go with it.
+		m_Entries.clear();
+		m_FailedEntryCount = 0;
+
+		return std::move(m_Ast);
+	}
+
+	Parser::TopLevelEntry Parser::ParseTopLevelEntry()
+	{
+		// Failing is told by the validity, the error count stops growing at the error limit.
+		const bool wasValid = std::exchange(m_IsValid, true);
+
+		TopLevelEntry entry;
+		entry.Begin     = GetCurrentToken().Offset;
+		entry.Node      = ParseTopLevelStatement();
+		entry.HasErrors = !m_IsValid;
+
+		m_IsValid = wasValid && m_IsValid;
+
+		return entry;
+	}
+
+	Statement* Parser::ParseTopLevelStatement()
+	{
+		const TokenType type = GetCurrentToken().Type;
+
+		Statement* statement = nullptr;
+
+		if (type == TokenType::IF_KEYWORD)
+			statement = ParseIfStatement();
+		else if (type == TokenType::RETURN_KEYWORD)
+			statement = ParseReturnStatement();
+		else if (type == TokenType::LET_KEYWORD)
+			statement = ParseVariableDeclaration();
+		else
+			ReportError(ParserErrorCode::UNEXPECTED_TOKEN, GetAndEatCurrentToken());
+
+		if (!statement)
+			SynchronizeAfterError();
+
+		return statement;
+	}
+
+	void Parser::AddTopLevelEntry(const TopLevelEntry& entry)
+	{
+		m_Entries.push_back(entry);
+		m_FailedEntryCount += entry.HasErrors;
+
+		if (entry.Node)
+			m_Ast.Statements.push_back(entry.Node);
+	}
+
+	void Parser::ApplyPendingShifts()
+	{
+		std::vector<Statement*> stack;
+
+		for (TopLevelEntry& entry : m_Entries)
+		{
+			if (entry.PendingShift == 0 || !entry.Node)
+				continue;
+
+			const i32 delta = std::exchange(entry.PendingShift, 0);
+
+			// Move every node of the statement.
+			const auto shiftScope = [&](Scope* scope) {
+				if (!scope)
+					return;
+
+				scope->ShiftLocation(delta);
+
+				for (Statement* statement : scope->GetStatements()) stack.push_back(statement);
+			};
+
+			stack.push_back(entry.Node);
+
+			while (!stack.empty())
 			{
-				Statement* expr = ParseReturnStatement();
-				if (!expr)
-				{
-					SynchronizeAfterError();
+				Statement* statement = stack.back();
+				stack.pop_back();
+
+				if (!statement)
 					continue;
-				}
 
-				m_Statements.push_back(expr);
+				statement->ShiftLocation(delta);
 
-				continue;
+				switch (statement->GetKind())
+				{
+				case NodeKind::BinaryExpression:
+					stack.push_back(static_cast<BinaryExpression*>(statement)->GetLeft());
+					stack.push_back(static_cast<BinaryExpression*>(statement)->GetRight());
+					break;
+				case NodeKind::UnaryExpression:
+					stack.push_back(static_cast<UnaryExpression*>(statement)->GetOperand());
+					break;
+				case NodeKind::PowerExpression:
+					stack.push_back(static_cast<PowerExpression*>(statement)->GetBase());
+					stack.push_back(static_cast<PowerExpression*>(statement)->GetExponent());
+					break;
+				case NodeKind::GroupingExpression:
+					stack.push_back(static_cast<GroupingExpression*>(statement)->GetExpression());
+					break;
+				case NodeKind::CallExpression:
+				{
+					const auto* call = static_cast<CallExpression*>(statement);
+
+					stack.push_back(call->GetDeclaration());
+					stack.insert(stack.end(), call->GetArgs().begin(), call->GetArgs().end());
+					break;
+				}
+				case NodeKind::IfStatement:
+					stack.push_back(static_cast<IfStatement*>(statement)->GetCondition());
+					shiftScope(static_cast<IfStatement*>(statement)->GetThenScope());
+					shiftScope(static_cast<IfStatement*>(statement)->GetElseScope());
+					break;
+				case NodeKind::ReturnStatement:
+					stack.push_back(static_cast<ReturnStatement*>(statement)->GetExpression());
+					break;
+				case NodeKind::VariableDeclaration:
+					stack.push_back(static_cast<VariableDeclaration*>(statement)->GetInitializer());
+					break;
+				default:
+					break;
+				}
 			}
+		}
+	}
 
-			const Token& token = GetAndEatCurrentToken();
-			if (token.Type == TokenType::END_OF_FILE)
-				break;
+	bool Parser::HasReachedErrorLimit() const
+	{
+		return m_ErrorLimit != 0 && m_ErrorCount + m_Tokens.GetLexerErrorCount() >= m_ErrorLimit;
+	}
+
+	std::nullptr_t Parser::ReportError(ParserErrorCode code, const Token& token)
+	{
+		m_IsValid = false;
 
-			Error::ReportError(ParserErrorCode::UNEXPECTED_TOKEN, token);
+		// Past the limit the stream already ended, what gets reported now are follow-ups of that.
+		if (HasReachedErrorLimit())
+			return nullptr;
 
-			SynchronizeAfterError();
+		if (m_ReportErrors)
+			Error::ReportError(code, token);
+
+		m_ErrorCount++;
+
+		if (HasReachedErrorLimit())
+		{
+			if (m_ReportErrors)
+				SYSTEM_ERROR("Too many errors, stopping.");
+
+			m_Tokens.SkipToEnd();
 		}
+
+		return nullptr;
 	}
 
 	void Parser::SynchronizeAfterError()
 	{
-		SYSTEM_ERROR("Synchronizing parser after error.");
 		m_IsValid = false;
 
+		u32 depth = 0; // Nesting depth of the braces skipped
+
 		while (!IsAtEnd())
 		{
 			switch (GetCurrentToken().Type)
 			{
-			case TokenType::IF_KEYWORD:
-			case TokenType::ELSE_KEYWORD:
-				// case TokenType::RETURN_KEYWORD:
-				if (!IsAtEnd())
+			case TokenType::SEMICOLON:
+				if (depth == 0)
+				{
 					EatCurrentToken();
-				return;
+					return;
+				}
+				break;
+			case TokenType::LEFT_BRACE:
+				depth++;
+				break;
+			case TokenType::RIGHT_BRACE:
+				if (depth == 0)
+					return;
+
+				// A scope followed by an else still belongs to the statement.
+				if (--depth == 0 && GetNextToken().Type != TokenType::ELSE_KEYWORD)
+				{
+					EatCurrentToken();
+					return;
+				}
+				break;
+			case TokenType::IF_KEYWORD:
+			case TokenType::RETURN_KEYWORD:
+			case TokenType::LET_KEYWORD:
+				if (depth == 0)
+					return;
+				break;
 			default:
-				EatCurrentToken();
+				break;
 			}
+
+			EatCurrentToken();
 		}
 	}
 
-	i32 Parser::GetTokenPrecedence(TokenType type) const
+	bool Parser::SynchronizeArgument()
 	{
-		switch (type)
+		u32 depth = 0; // Nesting depth of the parentheses skipped
+
+		while (true)
 		{
-		case TokenType::DOUBLE_STAR:
-		case TokenType::PERCENT:
-			return 6;
-		case TokenType::STAR:
-		case TokenType::SLASH:
-			return 5;
-		case TokenType::PLUS:
-		case TokenType::MINUS:
-			return 4;
-		case TokenType::LESS:
-		case TokenType::LESS_EQUAL:
-		case TokenType::GREATER:
-		case TokenType::GREATER_EQUAL:
-			return 3;
-		case TokenType::EQUAL_EQUAL:
-		case TokenType::BANG_EQUAL:
-			return 2;
-		default:
-			return -1;
+			switch (GetCurrentToken().Type)
+			{
+			case TokenType::LEFT_PARENTHESES:
+				depth++;
+				break;
+			case TokenType::RIGHT_PARENTHESES:
+				if (depth == 0)
+					return true;
+
+				depth--;
+				break;
+			case TokenType::COMMA:
+				if (depth == 0)
+					return true;
+				break;
+			case TokenType::SEMICOLON:
+			case TokenType::LEFT_BRACE:
+			case TokenType::RIGHT_BRACE:
+			case TokenType::END_OF_FILE:
+				return false;
+			default:
+				break;
+			}
+
+			EatCurrentToken();
 		}
 	}
 
 	Expression* Parser::ParseLiteral()
 	{
-		const Token& token = GetCurrentToken();
+		const Token token = GetCurrentToken();
 
-		if (token.Type == TokenType::LEFT_PARENTHESES)
+		if (token.Type == TokenType::NUMBER)
 		{
-			EatCurrentToken(); // eat the left parentheses
-
-			Expression* expr = ParseExpression();
-
-			if (GetCurrentToken().Type != TokenType::RIGHT_PARENTHESES) // missing right parentheses
-			{
-				return Error::ReportError(ParserErrorCode::MISSING_RIGHT_PARENTHESIS, GetPreviousToken());
-			}
-
-			EatCurrentToken(); // eat the right parentheses
+			EatCurrentToken();
 
-			return new GroupingExpression(token.Location, expr);
+			return m_Ast.Arena.Create<NumberLiteral>(token.GetLocation(), token.Value);
 		}
 
-		if (token.Type == TokenType::NUMBER)
+		if (token.Type == TokenType::VARIABLE_IDENTIFIER)
 		{
 			EatCurrentToken();
 
-			return new NumberLiteral(token.Location, std::stoi(token.Lexeme.value()));
+			return m_Ast.Arena.Create<VariableExpression>(token.GetLocation(), token.Symbol);
 		}
 
 		if (token.Type == TokenType::FUNCTION_IDENTIFIER)
 		{
 			if (GetNextToken().Type != TokenType::LEFT_PARENTHESES)
 			{
-				return Error::ReportError(ParserErrorCode::MISSING_LEFT_PARENTHESIS, token);
+				return ReportError(ParserErrorCode::MISSING_LEFT_PARENTHESIS, token);
 			}
 
 			EatCurrentToken(); // eat the function identifier
 
-			return new CallExpression(token.Location, new Declaration(GetCurrentToken().Location, token.Lexeme.value()),
-			                          ParseArguments());
+			Declaration* declaration = m_Ast.Arena.Create<Declaration>(GetCurrentToken().GetLocation(), token.Symbol);
+
+			const std::optional<std::span<Expression*>> args = ParseArguments();
+			if (!args)
+				return nullptr;
+
+			return m_Ast.Arena.Create<CallExpression>(token.GetLocation(), declaration, *args);
 		}
 
 		if (GetPreviousToken().Type == TokenType::RETURN_KEYWORD)
 		{
-			return Error::ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
+			return ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
 		}
 
-		return Error::ReportError(ParserErrorCode::MISSING_EXPRESSION, token);
+		return ReportError(ParserErrorCode::MISSING_EXPRESSION, token);
 	}
 
-	Expression* Parser::ParsePrefixExpression()
+	Expression* Parser::ParseExpression()
 	{
-		const Token& token = GetCurrentToken();
+		const size_t operandBase  = m_OperandStack.size();
+		const size_t operatorBase = m_OperatorStack.size();
+
+		u32 openParentheses = 0; // Opened within this expression and not closed yet
 
-		if (token.Type == TokenType::MINUS)
+		while (true)
 		{
-			EatCurrentToken();
+			const Token token = GetCurrentToken();
 
-			valueOrReturnNullptr(Expression*, expr, ParseLiteral());
+			// Opening parentheses and prefix operators wait on the stack for the operand they apply to.
+			if (token.Type == TokenType::LEFT_PARENTHESES)
+			{
+				m_OperatorStack.push_back({token, false});
+				openParentheses++;
 
-			return new UnaryExpression(token.Location, expr, token.Type);
-		}
+				EatCurrentToken();
+				continue;
+			}
 
-		return ParseLiteral();
-	}
+			if (m_Operators.GetPrefix(token.Type).IsOperator())
+			{
+				m_OperatorStack.push_back({token, true});
 
-	Expression* Parser::ParseExpression()
-	{
-		valueOrReturnNullptr(Expression*, lhs, ParsePrefixExpression());
+				EatCurrentToken();
+				continue;
+			}
 
-		return ParseExpressionRHS(lhs, 0);
-	}
+			Expression* operand = ParseLiteral();
+			if (!operand)
+			{
+				AbandonExpression(operandBase, operatorBase);
 
-	Expression* Parser::ParseExpressionRHS(Expression*& lhs, i32 precedence)
-	{
-		while (true)
-		{
-			const Token& token  = GetCurrentToken(); // should be an operator
-			i32 tokenPrecedence = GetTokenPrecedence(token.Type);
+				return nullptr;
+			}
 
-			if (!IsExpressionOperator(token.Type))
-				return lhs;
+			m_OperandStack.push_back(operand);
 
-			EatCurrentToken();
+			// Close the groupings that end after the operand.
+			while (openParentheses > 0 && GetCurrentToken().Type == TokenType::RIGHT_PARENTHESES)
+			{
+				while (m_OperatorStack.back().Operator.Type != TokenType::LEFT_PARENTHESES) ReduceOperator();
+
+				const SourceLocation location = m_OperatorStack.back().Operator.GetLocation();
+				m_OperatorStack.pop_back();
+				openParentheses--;
 
-			valueOrReturnNullptr(Expression*, rhs, ParseLiteral());
+				m_OperandStack.back() = m_Ast.Arena.Create<GroupingExpression>(location, m_OperandStack.back());
+
+				EatCurrentToken(); // eat the right parentheses
+			}
+
+			const Token op           = GetCurrentToken();
+			const OperatorInfo& info = m_Operators.GetBinary(op.Type);
+
+			if (!info.IsOperator())
+				break;
 
-			if (tokenPrecedence < GetTokenPrecedence(GetCurrentToken().Type))
+			// Operators on the stack that bind tighter, or as tight and group to the left, are complete.
+			while (m_OperatorStack.size() > operatorBase)
 			{
-				rhs = ParseExpressionRHS(rhs, tokenPrecedence + 1);
+				const PendingOperator& pending = m_OperatorStack.back();
+
+				if (pending.Operator.Type == TokenType::LEFT_PARENTHESES)
+					break;
+
+				const i32 precedence = pending.IsPrefix ? m_Operators.GetPrefix(pending.Operator.Type).Precedence
+				                                        : m_Operators.GetBinary(pending.Operator.Type).Precedence;
+
+				if (precedence < info.Precedence ||
+				    (precedence == info.Precedence && info.Direction == Associativity::Right))
+					break;
+
+				ReduceOperator();
 			}
 
-			if (token.Type == TokenType::DOUBLE_STAR)
-				lhs = new PowerExpression(token.Location, lhs, rhs);
-			else
-				lhs = new BinaryExpression(token.Location, lhs, rhs, token.Type);
+			m_OperatorStack.push_back({op, false});
+
+			EatCurrentToken();
+		}
+
+		if (openParentheses > 0) // missing right parentheses
+		{
+			AbandonExpression(operandBase, operatorBase);
+
+			return ReportError(ParserErrorCode::MISSING_RIGHT_PARENTHESIS, GetPreviousToken());
 		}
 
-		return lhs;
+		while (m_OperatorStack.size() > operatorBase) ReduceOperator();
+
+		Expression* expression = m_OperandStack.back();
+		m_OperandStack.pop_back();
+
+		return expression;
+	}
+
+	void Parser::ReduceOperator()
+	{
+		const Token token   = m_OperatorStack.back().Operator;
+		const bool isPrefix = m_OperatorStack.back().IsPrefix;
+		m_OperatorStack.pop_back();
+
+		Expression* rhs = m_OperandStack.back();
+		m_OperandStack.pop_back();
+
+		if (isPrefix)
+		{
+			m_OperandStack.push_back(m_Ast.Arena.Create<UnaryExpression>(token.GetLocation(), rhs, token.Type));
+
+			return;
+		}
+
+		Expression*& lhs = m_OperandStack.back();
+
+		if (token.Type == TokenType::DOUBLE_STAR)
+			lhs = m_Ast.Arena.Create<PowerExpression>(token.GetLocation(), lhs, rhs);
+		else
+			lhs = m_Ast.Arena.Create<BinaryExpression>(token.GetLocation(), lhs, rhs, token.Type);
 	}
 
 	// does eat ( and )
-	std::vector<Expression*> Parser::ParseArguments()
+	std::optional<std::span<Expression*>> Parser::ParseArguments()
 	{
-		std::vector<Expression*> args;
+		const size_t base = m_ExpressionStack.size();
 
 		EatCurrentToken(); // eat the left parentheses
 
 		while (true)
 		{
-			const Token& token = GetCurrentToken();
+			const Token token = GetCurrentToken();
 
 			if (token.Type == TokenType::RIGHT_PARENTHESES)
 				break;
 
 			if (token.Type == TokenType::END_OF_FILE)
 			{
-				Error::ReportError(ParserErrorCode::MISSING_RIGHT_PARENTHESIS, GetPreviousToken());
+				m_ExpressionStack.resize(base);
+				ReportError(ParserErrorCode::MISSING_RIGHT_PARENTHESIS, GetPreviousToken());
 
-				return args;
+				return std::nullopt;
 			}
 
 			Expression* expr = ParseExpression();
 			if (!expr)
 			{
-				SynchronizeAfterError();
+				// Skip the broken argument and go on with the next one.
+				if (!SynchronizeArgument())
+				{
+					m_ExpressionStack.resize(base);
+
+					return std::nullopt;
+				}
+
+				if (GetCurrentToken().Type == TokenType::COMMA)
+					EatCurrentToken();
+
 				continue;
 			}
 
 			if (GetCurrentToken().Type == TokenType::COMMA)
 				EatCurrentToken(); // eat the comma if multiple arguments
 
-			args.push_back(expr);
+			m_ExpressionStack.push_back(expr);
 		}
 
 		EatCurrentToken(); // eat the right parentheses
 
-		const Token& token = GetCurrentToken();
-
-		if (token.Type != TokenType::SEMICOLON)
-		{
-			Error::ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
-
-			return args;
-		}
-
-		EatCurrentToken(); // eat the semicolon
-
-		return args;
+		return PopChildren(m_ExpressionStack, base);
 	}
 
 	Scope* Parser::ParseScope()
 	{
-		const Token& token = GetAndEatCurrentToken(); // eat the left brace
+		if (GetCurrentToken().Type != TokenType::LEFT_BRACE)
+			return ReportError(ParserErrorCode::MISSING_LEFT_BRACE, GetPreviousToken());
+
+		const Token token = GetAndEatCurrentToken(); // eat the left brace
 
-		std::vector<Statement*> statements;
+		const size_t base = m_StatementStack.size();
 
 		while (true)
 		{
-			const Token& currentToken = GetCurrentToken();
+			const Token currentToken = GetCurrentToken();
 
 			if (currentToken.Type == TokenType::RIGHT_BRACE)
 				break;
 
 			if (currentToken.Type == TokenType::END_OF_FILE)
 			{
-				return Error::ReportError(ParserErrorCode::MISSING_SCOPE_CLOSING, token);
+				m_StatementStack.resize(base);
+
+				return ReportError(ParserErrorCode::MISSING_SCOPE_CLOSING, token);
 			}
 
+			// A statement that fails to parse is left out, the scope goes on with the next one.
 			Statement* statement = ParseStatement();
 			if (!statement)
 			{
-				return nullptr;
+				SynchronizeAfterError();
+				continue;
 			}
 
-			statements.push_back(statement);
+			m_StatementStack.push_back(statement);
 		}
 
 		EatCurrentToken(); // eat the right brace
 
-		return new Scope(token.Location, statements);
+		return m_Ast.Arena.Create<Scope>(token.GetLocation(), PopChildren(m_StatementStack, base));
 	}
 
 	Statement* Parser::ParseStatement()
 	{
-		const Token& token = GetCurrentToken();
+		const Token token = GetCurrentToken();
 
 		if (token.Type == TokenType::IF_KEYWORD)
 		{
@@ -297,11 +780,26 @@ namespace WandeltCore
 		{
 			return ParseReturnStatement();
 		}
+		else if (token.Type == TokenType::LET_KEYWORD)
+		{
+			return ParseVariableDeclaration();
+		}
+
+		const u32 errorCount = m_ErrorCount;
 
 		Statement* statement = ParseExpression();
-		if (!statement)
+		if (!statement && m_ErrorCount == errorCount)
+		{
+			return ReportError(ParserErrorCode::UNEXPECTED_TOKEN, token);
+		}
+
+		// A call used as a statement ends with a semicolon.
+		if (statement && statement->GetKind() == NodeKind::CallExpression)
 		{
-			return Error::ReportError(ParserErrorCode::UNEXPECTED_TOKEN, token);
+			if (GetCurrentToken().Type != TokenType::SEMICOLON)
+				return ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
+
+			EatCurrentToken(); // eat the semicolon
 		}
 
 		return statement;
@@ -309,27 +807,29 @@ namespace WandeltCore
 
 	Statement* Parser::ParseIfStatement()
 	{
-		const Token& token = GetAndEatCurrentToken(); // eat the if keyword
+		const Token token = GetAndEatCurrentToken(); // eat the if keyword
 
 		valueOrReturnNullptr(Expression*, condition, ParseExpression());
 
 		valueOrReturnNullptr(Scope*, trueScope, ParseScope());
 
 		if (GetCurrentToken().Type != TokenType::ELSE_KEYWORD)
-			return new IfStatement(token.Location, condition, trueScope, nullptr);
+			return m_Ast.Arena.Create<IfStatement>(token.GetLocation(), condition, trueScope, nullptr);
 
 		EatCurrentToken(); // eat the else keyword
 
 		Scope* falseScope = nullptr;
 
-		const Token& nextToken = GetCurrentToken();
+		const Token nextToken = GetCurrentToken();
 
 		if (nextToken.Type == TokenType::IF_KEYWORD)
 		{
 			// else if
 			valueOrReturnNullptr(Statement*, elseIf, ParseIfStatement());
 
-			falseScope = new Scope(nextToken.Location, {elseIf});
+			const std::span<Statement*> statements = m_Ast.Arena.CopyArray<Statement*>({&elseIf, 1});
+
+			falseScope = m_Ast.Arena.Create<Scope>(nextToken.GetLocation(), statements);
 		}
 		else
 		{
@@ -340,17 +840,17 @@ namespace WandeltCore
 		if (!falseScope)
 			return nullptr;
 
-		return new IfStatement(token.Location, condition, trueScope, falseScope);
+		return m_Ast.Arena.Create<IfStatement>(token.GetLocation(), condition, trueScope, falseScope);
 	}
 
 	Statement* Parser::ParseReturnStatement()
 	{
 		EatCurrentToken(); // eat the return keyword
-		const Token& token = GetCurrentToken();
+		const Token token = GetCurrentToken();
 
 		if (token.Type == TokenType::END_OF_FILE)
 		{
-			return Error::ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
+			return ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
 		}
 
 		if (token.Type != TokenType::SEMICOLON)
@@ -359,17 +859,44 @@ namespace WandeltCore
 
 			if (GetCurrentToken().Type != TokenType::SEMICOLON)
 			{
-				return Error::ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
+				return ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
 			}
 
 			EatCurrentToken(); // eat the semicolon
 
-			return new ReturnStatement(token.Location, expr);
+			return m_Ast.Arena.Create<ReturnStatement>(token.GetLocation(), expr);
 		}
 
 		EatCurrentToken();
 
 		// TODO consider returning void
-		return new ReturnStatement(token.Location, new NumberLiteral(token.Location, 0));
+		NumberLiteral* zero = m_Ast.Arena.Create<NumberLiteral>(token.GetLocation(), 0);
+
+		return m_Ast.Arena.Create<ReturnStatement>(token.GetLocation(), zero);
+	}
+
+	Statement* Parser::ParseVariableDeclaration()
+	{
+		const Token token = GetAndEatCurrentToken(); // eat the let keyword
+		const Token name  = GetCurrentToken();
+
+		if (name.Type != TokenType::VARIABLE_IDENTIFIER)
+			return ReportError(ParserErrorCode::MISSING_VARIABLE_IDENTIFIER, name);
+
+		EatCurrentToken(); // eat the variable identifier
+
+		if (GetCurrentToken().Type != TokenType::EQUALS)
+			return ReportError(ParserErrorCode::MISSING_EQUALS, name);
+
+		EatCurrentToken(); // eat the equals
+
+		valueOrReturnNullptr(Expression*, initializer, ParseExpression());
+
+		if (GetCurrentToken().Type != TokenType::SEMICOLON)
+			return ReportError(ParserErrorCode::MISSING_SEMICOLON, GetPreviousToken());
+
+		EatCurrentToken(); // eat the semicolon
+
+		return m_Ast.Arena.Create<VariableDeclaration>(token.GetLocation(), name.Symbol, initializer);
 	}
 } // namespace WandeltCore
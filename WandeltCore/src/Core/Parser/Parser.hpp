@@ -9,55 +9,135 @@
 #pragma once
 
 #include "Core/AST/AST.hpp"
-#include "Core/Lexer/Token.hpp"
+#include "Core/Lexer/TokenStream.hpp"
+#include "Core/Parser/OperatorTable.hpp"
 
 namespace WandeltCore
 {
 	class Parser
 	{
 	public:
-		Parser(const std::vector<Token>& tokens);
-		~Parser();
+		// Tokens are read through the stream, either lexed up front or pulled from the lexer on demand.
+		// Tokens are small PODs, hold on to copies of them, references into a streaming window do not last.
+		// How operators bind is read from the operator table.
+		Parser(TokenStream tokens, const OperatorTable& operators = OperatorTable::Default());
 
+		// Parse all tokens into GetStatements(). Large inputs lexed up front are split at top level statement
+		// boundaries into chunks that are parsed in parallel, the resulting AST is the same as when parsing serially.
 		void Parse();
 
-		const std::vector<Statement*>& GetStatements() const { return m_Statements; }
+		// The parsed top level statements. Applies the offset changes Reparse left pending on reused statements.
+		const std::vector<Statement*>& GetStatements();
+
+		// Hand the parsed AST over to the next phase. The parser is empty afterwards.
+		Ast TakeAst();
+
+		// Apply the edit to the parsed file and bring the AST up to date. Only the top level statements from the one
+		// the edit starts in up to where the tokens line up with the old ones again are relexed and reparsed, all
+		// others are reused and shifted. Errors in the reparsed part get reported, the error limit applies to each
+		// edit. Works on the AST the parser holds, so TakeAst must not have been called. Replaced statements stay in
+		// the arena until they take up as much of it as the live ones, then the whole file is parsed into a fresh
+		// arena and all statements are replaced.
+		void Reparse(const SourceEdit& edit);
 
 		bool IsValid() const { return m_IsValid; }
 
+		// Stop parsing once this many errors were reported, counting those of the lexer tokens are streamed from.
+		// 0 for no limit.
+		void SetErrorLimit(u32 limit) { m_ErrorLimit = limit; }
+
+		u32 GetErrorCount() const { return m_ErrorCount; }
+		bool HasReachedErrorLimit() const;
+
+		// Whether Parse splits the tokens into chunks parsed in parallel.
+		bool IsParsedInParallel() const;
+
+		// Inputs of at least this many tokens are parsed in parallel, unless they are streamed.
+		static constexpr u32 ParallelThreshold = 128 * 1024;
+
+		// Split the tokens into at most chunkCount chunks of roughly equal size. Chunks end right after a top level
+		// statement, a ';' or a '}' not followed by 'else' outside of any braces. Returns the index of the first
+		// token of every chunk, followed by the number of tokens.
+		static std::vector<u32> FindStatementBoundaries(std::span<const Token> tokens, u32 chunkCount);
+
 	private:
-		// Synchronize the parser after an error has occurred to prevent cascading errors.
+		// One iteration of the top level parse loop: a statement, or the tokens skipped after an error.
+		struct TopLevelEntry
+		{
+			u32 Begin        = 0;       // Offset of the first token
+			i32 PendingShift = 0;       // Offset change not yet applied to the nodes of the statement
+			Statement* Node  = nullptr; // nullptr if the statement failed to parse
+			bool HasErrors   = false;
+		};
+
+		void ParseSerial();
+		void ParseParallel();
+
+		// Relex and reparse the whole file, after lexing errors that are not tracked per entry.
+		void ReparseAll();
+
+		// Parse the whole file again and assert the AST and the validity are the same as after the reparse. Run
+		// after every incremental reparse in debug builds.
+		void CheckReparse();
+
+		// Replaced statements below this many bytes are not worth parsing the whole file again for.
+		static constexpr size_t MinReplacedBytes = 64 * 1024;
+
+		TopLevelEntry ParseTopLevelEntry();
+		Statement* ParseTopLevelStatement();
+
+		void AddTopLevelEntry(const TopLevelEntry& entry);
+
+		void ApplyPendingShifts();
+
+		// Report the error unless this parser works on a chunk, either way the parser is no longer valid.
+		// Reaching the error limit ends the token stream, so parsing winds down without reading any further.
+		std::nullptr_t ReportError(ParserErrorCode code, const Token& token);
+
+		// Synchronize the parser after a statement failed to parse to prevent cascading errors. Skips to the end of
+		// the statement, a ';' or the end of a scope, or to the start of the next one. Stops in front of a '}' that
+		// closes the enclosing scope. Every token is skipped at most once, so recovering costs O(tokens) overall.
 		void SynchronizeAfterError();
 
-		// Whether the token is an operator, meaning it can be used in an expression
-		// to perform an operation like addition.
-		bool IsExpressionOperator(TokenType type) const
-		{
-			return type == TokenType::PLUS || type == TokenType::MINUS || type == TokenType::STAR ||
-			       type == TokenType::SLASH || type == TokenType::DOUBLE_STAR || type == TokenType::PERCENT ||
-			       type == TokenType::EQUAL_EQUAL || type == TokenType::BANG_EQUAL || type == TokenType::LESS ||
-			       type == TokenType::LESS_EQUAL || type == TokenType::GREATER || type == TokenType::GREATER_EQUAL;
-		}
+		// Synchronize the parser after an argument failed to parse. Skips to the ',' or ')' that ends it. Returns
+		// false if the argument list ends before, at a ';', a brace or the end of the file.
+		bool SynchronizeArgument();
 
 		// Check if we are at the end of the source file
-		bool IsAtEnd() const { return m_Tokens.at(m_Current).Type == TokenType::END_OF_FILE; }
+		bool IsAtEnd() const { return m_Tokens.GetCurrent().Type == TokenType::END_OF_FILE; }
 
-		const Token& GetPreviousToken() const { return m_Tokens.at(m_Current - 1); }
-		const Token& GetCurrentToken() const { return m_Tokens.at(m_Current); }
-		const Token& GetAndEatCurrentToken() { return m_Tokens.at(m_Current++); }
-		const Token& GetNextToken() const { return m_Tokens.at(m_Current + 1); }
+		const Token& GetPreviousToken() const { return m_Tokens.GetPrevious(); }
+		const Token& GetCurrentToken() const { return m_Tokens.GetCurrent(); }
+		const Token& GetNextToken() const { return m_Tokens.GetNext(); }
 
-		i32 GetTokenPrecedence(TokenType type) const;
+		Token GetAndEatCurrentToken()
+		{
+			const Token token = m_Tokens.GetCurrent();
+			m_Tokens.Advance();
+			return token;
+		}
 
-		void EatCurrentToken() { m_Current++; }
+		void EatCurrentToken() { m_Tokens.Advance(); }
 
 		Expression* ParseLiteral();
 
-		Expression* ParsePrefixExpression();
+		// Parse an expression with the operators and operands on explicit stacks, so neither long operator
+		// chains nor deeply nested parentheses grow the native call stack.
 		Expression* ParseExpression();
-		Expression* ParseExpressionRHS(Expression*& lhs, i32 precedence);
 
-		std::vector<Expression*> ParseArguments();
+		// Pop the operator on top of the stack and combine it with its operands into one expression.
+		void ReduceOperator();
+
+		// Drop what an expression that failed to parse left on the stacks.
+		void AbandonExpression(size_t operandBase, size_t operatorBase)
+		{
+			m_OperandStack.resize(operandBase);
+			m_OperatorStack.resize(operatorBase);
+		}
+
+		// Parse the argument list of a call, the arguments are stored in the arena. Arguments that fail to parse are
+		// skipped, std::nullopt if the list itself is broken.
+		std::optional<std::span<Expression*>> ParseArguments();
 
 		Scope* ParseScope();
 
@@ -65,13 +145,48 @@ namespace WandeltCore
 
 		Statement* ParseIfStatement();
 		Statement* ParseReturnStatement();
+		Statement* ParseVariableDeclaration();
+
+		// Move the children pushed onto the stack since base into the arena. Child lists are collected on
+		// stacks shared by all nesting levels, so building them allocates nothing besides the arena copy.
+		template <typename T>
+		std::span<T> PopChildren(std::vector<T>& stack, size_t base)
+		{
+			const std::span<T> children = m_Ast.Arena.CopyArray<T>(std::span<const T>(stack).subspan(base));
+			stack.resize(base);
+
+			return children;
+		}
 
 	private:
-		i32 m_Current = 0;
+		// An operator or an opening parenthesis on the operator stack, waiting for its operands.
+		struct PendingOperator
+		{
+			Token Operator;
+			bool IsPrefix = false;
+		};
+
+		bool m_IsValid      = true; // Whether the parser is in a valid state. Meaning no errors have occurred.
+		bool m_ReportErrors = true; // Whether errors get logged, false for chunks parsed in parallel
+
+		u32 m_ErrorCount = 0; // Errors reported so far
+		u32 m_ErrorLimit = 0; // Errors after which parsing stops, 0 for no limit
+
+		TokenStream m_Tokens;
+		OperatorTable m_Operators;
+
+		Ast m_Ast; // The parsed statements and the arena that owns them
 
-		bool m_IsValid = true; // Whether the parser is in a valid state. Meaning no errors have occurred.
+		// What Reparse needs to know about the last parse.
+		std::vector<TopLevelEntry> m_Entries;    // The iterations of the top level loop in source order
+		u32 m_FailedEntryCount  = 0;             // Entries with errors
+		u16 m_FileID            = InvalidFileID; // The parsed file
+		bool m_NeedsFullReparse = false;         // Whether lexing failed, so the next edit relexes the whole file
+		size_t m_ParsedBytes    = 0;             // Arena bytes used right after the last full parse
 
-		std::vector<Token> m_Tokens;
-		std::vector<Statement*> m_Statements;
+		std::vector<Statement*> m_StatementStack;     // Statements of the scopes being parsed
+		std::vector<Expression*> m_ExpressionStack;   // Arguments of the calls being parsed
+		std::vector<Expression*> m_OperandStack;      // Operands of the expressions being parsed
+		std::vector<PendingOperator> m_OperatorStack; // Operators and open parentheses of the expressions being parsed
 	};
 } // namespace WandeltCore
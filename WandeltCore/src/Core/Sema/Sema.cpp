@@ -2,5 +2,1003 @@
 
 namespace WandeltCore
 {
+	namespace
+	{
+		// i32 arithmetic wraps around like the LLVM instructions without nsw and nuw codegen emits, so it is done
+		// on u32.
+		i32 Wrap(u32 value)
+		{
+			return static_cast<i32>(value);
+		}
 
-}
+		std::optional<i32> FoldBinary(TokenType op, i32 lhs, i32 rhs)
+		{
+			const u32 left  = static_cast<u32>(lhs);
+			const u32 right = static_cast<u32>(rhs);
+
+			switch (op)
+			{
+			case TokenType::PLUS:
+				return Wrap(left + right);
+			case TokenType::MINUS:
+				return Wrap(left - right);
+			case TokenType::STAR:
+				return Wrap(left * right);
+			case TokenType::SLASH:
+			case TokenType::PERCENT:
+				if (rhs == 0 || (lhs == std::numeric_limits<i32>::min() && rhs == -1))
+					return std::nullopt;
+
+				return op == TokenType::SLASH ? lhs / rhs : lhs % rhs;
+			case TokenType::EQUAL_EQUAL:
+				return lhs == rhs;
+			case TokenType::BANG_EQUAL:
+				return lhs != rhs;
+			case TokenType::LESS:
+				return lhs < rhs;
+			case TokenType::LESS_EQUAL:
+				return lhs <= rhs;
+			case TokenType::GREATER:
+				return lhs > rhs;
+			case TokenType::GREATER_EQUAL:
+				return lhs >= rhs;
+			default:
+				return std::nullopt;
+			}
+		}
+
+		i32 FoldPower(i32 base, i32 exponent)
+		{
+			// x ** 0 is 1, and a negative exponent leaves the base as it is.
+			if (exponent <= 0)
+				return exponent == 0 ? 1 : base;
+
+			// Squaring wraps around the same as multiplying exponent times, in O(log exponent).
+			u32 result = 1;
+			u32 factor = static_cast<u32>(base);
+
+			for (u32 remaining = static_cast<u32>(exponent); remaining != 0; remaining >>= 1)
+			{
+				if (remaining & 1)
+					result *= factor;
+
+				factor *= factor;
+			}
+
+			return Wrap(result);
+		}
+
+		constexpr i64 MinInt32 = std::numeric_limits<i32>::min();
+		constexpr i64 MaxInt32 = std::numeric_limits<i32>::max();
+
+		// The comparison that holds with the operands swapped, a < b is b > a.
+		TokenType MirrorComparison(TokenType op)
+		{
+			switch (op)
+			{
+			case TokenType::LESS:
+				return TokenType::GREATER;
+			case TokenType::LESS_EQUAL:
+				return TokenType::GREATER_EQUAL;
+			case TokenType::GREATER:
+				return TokenType::LESS;
+			case TokenType::GREATER_EQUAL:
+				return TokenType::LESS_EQUAL;
+			default:
+				return op;
+			}
+		}
+
+		// The comparison that holds when the comparison does not, in the else scope.
+		TokenType NegateComparison(TokenType op)
+		{
+			switch (op)
+			{
+			case TokenType::EQUAL_EQUAL:
+				return TokenType::BANG_EQUAL;
+			case TokenType::BANG_EQUAL:
+				return TokenType::EQUAL_EQUAL;
+			case TokenType::LESS:
+				return TokenType::GREATER_EQUAL;
+			case TokenType::LESS_EQUAL:
+				return TokenType::GREATER;
+			case TokenType::GREATER:
+				return TokenType::LESS_EQUAL;
+			case TokenType::GREATER_EQUAL:
+				return TokenType::LESS;
+			default:
+				return op;
+			}
+		}
+
+		const Expression* SkipGroupings(const Expression* expression)
+		{
+			while (expression->GetKind() == NodeKind::GroupingExpression)
+				expression = static_cast<const GroupingExpression*>(expression)->GetExpression();
+
+			return expression;
+		}
+	} // namespace
+
+	Sema::Sema(Ast& ast) : m_Ast(ast)
+	{
+	}
+
+	bool Sema::Analyze()
+	{
+		if (!ResolveNames())
+			return false;
+
+		FoldConstants();
+		EliminateDeadCode();
+		InferTypes();
+		AnalyzeRanges();
+
+		return true;
+	}
+
+	bool Sema::ResolveNames()
+	{
+		bool isValid = true;
+
+		// The top level statements are in a scope of their own.
+		m_Symbols.PushScope();
+
+		for (auto it = m_Ast.Statements.rbegin(); it != m_Ast.Statements.rend(); ++it) m_Stack.push_back({*it});
+
+		while (!m_Stack.empty())
+		{
+			Entry& entry = m_Stack.back();
+
+			if (entry.IsExpanded)
+			{
+				const Entry done = entry;
+				m_Stack.pop_back();
+
+				// A variable is declared after its initializer, which still sees the variables around it.
+				if (done.ScopeNode)
+					m_Symbols.PopScope();
+				else if (done.Node->GetKind() == NodeKind::VariableDeclaration)
+					isValid &= DeclareVariable(static_cast<VariableDeclaration*>(done.Node));
+
+				continue;
+			}
+
+			if (entry.Node && entry.Node->GetKind() == NodeKind::VariableExpression)
+			{
+				Statement* statement = entry.Node;
+				m_Stack.pop_back();
+
+				isValid &= ResolveVariable(static_cast<VariableExpression*>(statement));
+				continue;
+			}
+
+			entry.IsExpanded = true;
+
+			if (entry.ScopeNode)
+			{
+				m_Symbols.PushScope();
+
+				const std::span<Statement*> statements = entry.ScopeNode->GetStatements();
+
+				for (auto it = statements.rbegin(); it != statements.rend(); ++it) m_Stack.push_back({*it});
+
+				continue;
+			}
+
+			PushChildren(entry.Node);
+		}
+
+		m_Symbols.PopScope();
+
+		m_Variables.resize(m_VariableCount);
+		m_VariableTypes.resize(m_VariableCount, ValueType::Int32);
+
+		return isValid;
+	}
+
+	void Sema::FoldConstants()
+	{
+		// Children are pushed last to first, so they come off the stack in source order.
+		for (auto it = m_Ast.Statements.rbegin(); it != m_Ast.Statements.rend(); ++it) m_Stack.push_back({*it});
+
+		while (!m_Stack.empty())
+		{
+			Entry& entry = m_Stack.back();
+
+			if (entry.IsExpanded)
+			{
+				const Entry done = entry;
+				m_Stack.pop_back();
+
+				if (done.ScopeNode)
+					FoldScope(done.ScopeNode);
+				else
+					FoldNode(done.Node);
+
+				continue;
+			}
+
+			entry.IsExpanded = true;
+
+			if (entry.ScopeNode)
+			{
+				const std::span<Statement*> statements = entry.ScopeNode->GetStatements();
+
+				for (auto it = statements.rbegin(); it != statements.rend(); ++it) m_Stack.push_back({*it});
+
+				continue;
+			}
+
+			PushChildren(entry.Node);
+		}
+
+		// Top level expressions left their values behind.
+		for (auto it = m_Ast.Statements.rbegin(); it != m_Ast.Statements.rend(); ++it)
+		{
+			if (IsExpression((*it)->GetKind()))
+				*it = Materialize(PopValue());
+		}
+
+		ASSERT(m_Values.empty(), "Values left after folding.");
+	}
+
+	void Sema::EliminateDeadCode()
+	{
+		const auto pushScopes = [this](std::span<Statement* const> statements) {
+			for (Statement* statement : statements)
+			{
+				if (statement->GetKind() != NodeKind::IfStatement)
+					continue;
+
+				const auto* ifStatement = static_cast<IfStatement*>(statement);
+
+				m_Scopes.push_back(ifStatement->GetThenScope());
+
+				if (ifStatement->HasElseScope())
+					m_Scopes.push_back(ifStatement->GetElseScope());
+			}
+		};
+
+		// Every scope comes after the one it is nested in.
+		pushScopes(m_Ast.Statements);
+
+		for (size_t i = 0; i < m_Scopes.size(); i++) pushScopes(m_Scopes[i]->GetStatements());
+
+		// Inner scopes first, so a branch spliced into its parent is cleaned up already.
+		for (auto it = m_Scopes.rbegin(); it != m_Scopes.rend(); ++it)
+		{
+			Scope* scope = *it;
+
+			m_LiveStatements.clear();
+
+			if (CollectLiveStatements(scope->GetStatements()))
+				scope->SetStatements(m_Ast.Arena.CopyArray<Statement*>(m_LiveStatements));
+		}
+
+		m_Scopes.clear();
+
+		m_LiveStatements.clear();
+
+		if (CollectLiveStatements(m_Ast.Statements))
+			m_Ast.Statements = m_LiveStatements;
+	}
+
+	void Sema::InferTypes()
+	{
+		// Post-order, the children have their type when their parent is left.
+		for (auto it = m_Ast.Statements.rbegin(); it != m_Ast.Statements.rend(); ++it) m_Stack.push_back({*it});
+
+		while (!m_Stack.empty())
+		{
+			Entry& entry = m_Stack.back();
+
+			if (entry.IsExpanded)
+			{
+				const Entry done = entry;
+				m_Stack.pop_back();
+
+				if (done.Node)
+					InferType(done.Node);
+
+				continue;
+			}
+
+			entry.IsExpanded = true;
+
+			if (entry.ScopeNode)
+			{
+				const std::span<Statement*> statements = entry.ScopeNode->GetStatements();
+
+				for (auto it = statements.rbegin(); it != statements.rend(); ++it) m_Stack.push_back({*it});
+
+				continue;
+			}
+
+			PushChildren(entry.Node);
+		}
+	}
+
+	void Sema::AnalyzeRanges()
+	{
+		m_VariableRanges.assign(m_VariableCount, Range{});
+
+		// Post-order like the other passes, a scope narrows the variables of its if statement while it is walked.
+		for (auto it = m_Ast.Statements.rbegin(); it != m_Ast.Statements.rend(); ++it) m_Stack.push_back({*it});
+
+		while (!m_Stack.empty())
+		{
+			Entry& entry = m_Stack.back();
+
+			if (entry.IsExpanded)
+			{
+				const Entry done = entry;
+				m_Stack.pop_back();
+
+				if (done.ScopeNode)
+					LeaveScopeRanges(done.ScopeNode);
+				else
+					AnalyzeRange(done.Node);
+
+				continue;
+			}
+
+			entry.IsExpanded = true;
+
+			if (entry.ScopeNode)
+			{
+				Scope* scope = entry.ScopeNode;
+
+				EnterScopeRanges(scope);
+
+				const std::span<Statement*> statements = scope->GetStatements();
+
+				for (auto it = statements.rbegin(); it != statements.rend(); ++it) m_Stack.push_back({*it});
+
+				continue;
+			}
+
+			if (entry.Node->GetKind() == NodeKind::IfStatement)
+				PushNarrowings(static_cast<IfStatement*>(entry.Node));
+
+			PushChildren(entry.Node);
+		}
+
+		// Top level expressions left their ranges behind.
+		m_Ranges.clear();
+
+		ASSERT(m_Narrowings.empty(), "Narrowings left after analyzing the ranges.");
+	}
+
+	bool Sema::CollectLiveStatements(std::span<Statement* const> statements)
+	{
+		bool isChanged = false;
+
+		for (Statement* statement : statements)
+		{
+			// Nothing behind a return is reached.
+			if (!m_LiveStatements.empty() && m_LiveStatements.back()->GetKind() == NodeKind::ReturnStatement)
+				return true;
+
+			// Every read of a variable with a constant initializer was replaced by the value.
+			if (statement->GetKind() == NodeKind::VariableDeclaration &&
+			    static_cast<VariableDeclaration*>(statement)->GetInitializer()->GetKind() == NodeKind::NumberLiteral)
+			{
+				isChanged = true;
+				continue;
+			}
+
+			if (statement->GetKind() != NodeKind::IfStatement)
+			{
+				m_LiveStatements.push_back(statement);
+				continue;
+			}
+
+			const auto* ifStatement     = static_cast<IfStatement*>(statement);
+			const Expression* condition = ifStatement->GetCondition();
+
+			if (condition->GetKind() != NodeKind::NumberLiteral)
+			{
+				m_LiveStatements.push_back(statement);
+				continue;
+			}
+
+			// Conditions are i32 like in codegen, wider literals wrap around.
+			const bool isTaken = static_cast<u32>(static_cast<const NumberLiteral*>(condition)->GetValue()) != 0;
+
+			const Scope* branch = isTaken ? ifStatement->GetThenScope() : ifStatement->GetElseScope();
+
+			if (branch)
+			{
+				const std::span<Statement*> branchStatements = branch->GetStatements();
+
+				m_LiveStatements.insert(m_LiveStatements.end(), branchStatements.begin(), branchStatements.end());
+			}
+
+			isChanged = true;
+		}
+
+		return isChanged;
+	}
+
+	void Sema::PushChildren(Statement* statement)
+	{
+		switch (statement->GetKind())
+		{
+		case NodeKind::BinaryExpression:
+			m_Stack.push_back({static_cast<BinaryExpression*>(statement)->GetRight()});
+			m_Stack.push_back({static_cast<BinaryExpression*>(statement)->GetLeft()});
+			break;
+		case NodeKind::UnaryExpression:
+			m_Stack.push_back({static_cast<UnaryExpression*>(statement)->GetOperand()});
+			break;
+		case NodeKind::PowerExpression:
+			m_Stack.push_back({static_cast<PowerExpression*>(statement)->GetExponent()});
+			m_Stack.push_back({static_cast<PowerExpression*>(statement)->GetBase()});
+			break;
+		case NodeKind::GroupingExpression:
+			m_Stack.push_back({static_cast<GroupingExpression*>(statement)->GetExpression()});
+			break;
+		case NodeKind::CallExpression:
+		{
+			const std::span<Expression*> args = static_cast<CallExpression*>(statement)->GetArgs();
+
+			for (auto it = args.rbegin(); it != args.rend(); ++it) m_Stack.push_back({*it});
+			break;
+		}
+		case NodeKind::IfStatement:
+		{
+			const auto* ifStatement = static_cast<IfStatement*>(statement);
+
+			if (ifStatement->HasElseScope())
+				m_Stack.push_back({nullptr, ifStatement->GetElseScope()});
+
+			m_Stack.push_back({nullptr, ifStatement->GetThenScope()});
+			m_Stack.push_back({ifStatement->GetCondition()});
+			break;
+		}
+		case NodeKind::ReturnStatement:
+			m_Stack.push_back({static_cast<ReturnStatement*>(statement)->GetExpression()});
+			break;
+		case NodeKind::VariableDeclaration:
+			m_Stack.push_back({static_cast<VariableDeclaration*>(statement)->GetInitializer()});
+			break;
+		default:
+			break;
+		}
+	}
+
+	bool Sema::DeclareVariable(VariableDeclaration* declaration)
+	{
+		const SymbolID name = declaration->GetName();
+
+		if (m_Symbols.Declare(name, m_VariableCount) != InvalidVariableID)
+		{
+			Error::ReportError(SemanticErrorCode::REDECLARED_VARIABLE, declaration->GetLocation(),
+			                   StringInterner::Get().GetString(name));
+
+			return false;
+		}
+
+		declaration->SetVariable(m_VariableCount++);
+
+		return true;
+	}
+
+	bool Sema::ResolveVariable(VariableExpression* variable)
+	{
+		const VariableID declared = m_Symbols.Lookup(variable->GetName());
+
+		if (declared == InvalidVariableID)
+		{
+			Error::ReportError(SemanticErrorCode::UNDECLARED_VARIABLE, variable->GetLocation(),
+			                   StringInterner::Get().GetString(variable->GetName()));
+
+			return false;
+		}
+
+		variable->SetVariable(declared);
+
+		return true;
+	}
+
+	void Sema::FoldNode(Statement* statement)
+	{
+		switch (statement->GetKind())
+		{
+		case NodeKind::NumberLiteral:
+		{
+			// Values are i32, wider literals wrap around.
+			const u64 value = static_cast<NumberLiteral*>(statement)->GetValue();
+
+			m_Values.push_back({static_cast<Expression*>(statement), Wrap(static_cast<u32>(value)), true});
+			break;
+		}
+		case NodeKind::BinaryExpression:
+		{
+			auto* binary = static_cast<BinaryExpression*>(statement);
+
+			const FoldedValue right = PopValue();
+			const FoldedValue left  = PopValue();
+
+			if (left.IsConstant && right.IsConstant)
+			{
+				if (const std::optional<i32> value = FoldBinary(binary->GetOperator(), left.Value, right.Value))
+				{
+					m_Values.push_back({binary, *value, true});
+					break;
+				}
+			}
+
+			binary->SetLeft(Materialize(left));
+			binary->SetRight(Materialize(right));
+
+			m_Values.push_back({binary});
+			break;
+		}
+		case NodeKind::UnaryExpression:
+		{
+			auto* unary = static_cast<UnaryExpression*>(statement);
+
+			const FoldedValue operand = PopValue();
+
+			if (operand.IsConstant && unary->GetOperator() == TokenType::MINUS)
+			{
+				m_Values.push_back({unary, Wrap(0u - static_cast<u32>(operand.Value)), true});
+				break;
+			}
+
+			unary->SetOperand(Materialize(operand));
+
+			m_Values.push_back({unary});
+			break;
+		}
+		case NodeKind::PowerExpression:
+		{
+			auto* power = static_cast<PowerExpression*>(statement);
+
+			const FoldedValue exponent = PopValue();
+			const FoldedValue base     = PopValue();
+
+			if (base.IsConstant && exponent.IsConstant)
+			{
+				m_Values.push_back({power, FoldPower(base.Value, exponent.Value), true});
+				break;
+			}
+
+			power->SetBase(Materialize(base));
+			power->SetExponent(Materialize(exponent));
+
+			m_Values.push_back({power});
+			break;
+		}
+		case NodeKind::GroupingExpression:
+		{
+			auto* grouping = static_cast<GroupingExpression*>(statement);
+
+			const FoldedValue expression = PopValue();
+
+			if (expression.IsConstant)
+			{
+				m_Values.push_back({grouping, expression.Value, true});
+				break;
+			}
+
+			grouping->SetExpression(Materialize(expression));
+
+			m_Values.push_back({grouping});
+			break;
+		}
+		case NodeKind::VariableExpression:
+		{
+			auto* variable = static_cast<VariableExpression*>(statement);
+
+			const FoldedValue& initializer = m_Variables[variable->GetVariable()];
+
+			m_Values.push_back({variable, initializer.Value, initializer.IsConstant});
+			break;
+		}
+		case NodeKind::CallExpression:
+		{
+			auto* call = static_cast<CallExpression*>(statement);
+
+			// Calls have side effects, they are never constant themselves.
+			const std::span<Expression*> args = call->GetArgs();
+
+			for (auto it = args.rbegin(); it != args.rend(); ++it) *it = Materialize(PopValue());
+
+			m_Values.push_back({call});
+			break;
+		}
+		case NodeKind::IfStatement:
+		{
+			auto* ifStatement = static_cast<IfStatement*>(statement);
+
+			ifStatement->SetCondition(Materialize(PopValue()));
+			break;
+		}
+		case NodeKind::ReturnStatement:
+		{
+			auto* returnStatement = static_cast<ReturnStatement*>(statement);
+
+			returnStatement->SetExpression(Materialize(PopValue()));
+			break;
+		}
+		case NodeKind::VariableDeclaration:
+		{
+			auto* declaration = static_cast<VariableDeclaration*>(statement);
+
+			const FoldedValue initializer = PopValue();
+
+			// Declarations come before the reads, they fold to the value if it is constant.
+			m_Variables[declaration->GetVariable()] = initializer;
+
+			declaration->SetInitializer(Materialize(initializer));
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	void Sema::FoldScope(Scope* scope)
+	{
+		// Expression statements left their values behind, last one on top.
+		const std::span<Statement*> statements = scope->GetStatements();
+
+		for (auto it = statements.rbegin(); it != statements.rend(); ++it)
+		{
+			if (IsExpression((*it)->GetKind()))
+				*it = Materialize(PopValue());
+		}
+	}
+
+	void Sema::InferType(Statement* statement)
+	{
+		switch (statement->GetKind())
+		{
+		case NodeKind::BinaryExpression:
+		{
+			auto* binary = static_cast<BinaryExpression*>(statement);
+
+			binary->SetType(IsComparisonOperator(binary->GetOperator()) ? ValueType::Bool : ValueType::Int32);
+			break;
+		}
+		case NodeKind::GroupingExpression:
+		{
+			auto* grouping = static_cast<GroupingExpression*>(statement);
+
+			grouping->SetType(grouping->GetExpression()->GetType());
+			break;
+		}
+		case NodeKind::VariableExpression:
+		{
+			auto* variable = static_cast<VariableExpression*>(statement);
+
+			variable->SetType(m_VariableTypes[variable->GetVariable()]);
+			break;
+		}
+		case NodeKind::VariableDeclaration:
+		{
+			const auto* declaration = static_cast<VariableDeclaration*>(statement);
+
+			m_VariableTypes[declaration->GetVariable()] = declaration->GetInitializer()->GetType();
+			break;
+		}
+		default:
+			// Literals, negations, powers and calls are Int32, as every expression starts out.
+			break;
+		}
+	}
+
+	void Sema::AnalyzeRange(Statement* statement)
+	{
+		switch (statement->GetKind())
+		{
+		case NodeKind::NumberLiteral:
+		{
+			const i32 value = Wrap(static_cast<u32>(static_cast<NumberLiteral*>(statement)->GetValue()));
+
+			m_Ranges.push_back({value, value});
+			break;
+		}
+		case NodeKind::BinaryExpression:
+		{
+			const Range right = PopRange();
+			const Range left  = PopRange();
+
+			m_Ranges.push_back(AnalyzeBinary(static_cast<BinaryExpression*>(statement), left, right));
+			break;
+		}
+		case NodeKind::UnaryExpression:
+		{
+			auto* unary = static_cast<UnaryExpression*>(statement);
+
+			const Range operand = PopRange();
+
+			// Negating INT_MIN is the only negation that wraps around.
+			if (unary->GetOperator() != TokenType::MINUS || operand.Min == MinInt32)
+			{
+				m_Ranges.push_back({});
+				break;
+			}
+
+			unary->AddFact(ArithmeticFact::NoSignedWrap);
+
+			m_Ranges.push_back({-operand.Max, -operand.Min, operand.IsNonZero});
+			break;
+		}
+		case NodeKind::PowerExpression:
+		{
+			const Range exponent = PopRange();
+			const Range base     = PopRange();
+
+			m_Ranges.push_back(AnalyzePower(static_cast<PowerExpression*>(statement), base, exponent));
+			break;
+		}
+		case NodeKind::GroupingExpression:
+			// The range of the grouped expression stays on the stack for the grouping.
+			break;
+		case NodeKind::VariableExpression:
+			m_Ranges.push_back(m_VariableRanges[static_cast<VariableExpression*>(statement)->GetVariable()]);
+			break;
+		case NodeKind::CallExpression:
+		{
+			// Nothing is known about what a call returns.
+			const size_t argCount = static_cast<CallExpression*>(statement)->GetArgs().size();
+
+			m_Ranges.resize(m_Ranges.size() - argCount);
+			m_Ranges.push_back({});
+			break;
+		}
+		case NodeKind::IfStatement:
+		case NodeKind::ReturnStatement:
+			// The scopes of an if statement took their ranges already, the condition is on top.
+			PopRange();
+			break;
+		case NodeKind::VariableDeclaration:
+			m_VariableRanges[static_cast<VariableDeclaration*>(statement)->GetVariable()] = PopRange();
+			break;
+		default:
+			break;
+		}
+	}
+
+	Sema::Range Sema::AnalyzeBinary(BinaryExpression* binary, const Range& left, const Range& right)
+	{
+		const TokenType op = binary->GetOperator();
+
+		if (IsComparisonOperator(op))
+			return {0, 1};
+
+		if (op == TokenType::SLASH || op == TokenType::PERCENT)
+		{
+			const bool isOneSign = right.Min > 0 || right.Max < 0;
+
+			if (isOneSign || right.IsNonZero)
+				binary->AddFact(ArithmeticFact::NonZeroDivisor);
+
+			if (left.Min > MinInt32 || right.Min > -1 || right.Max < -1)
+				binary->AddFact(ArithmeticFact::NoDivisionOverflow);
+
+			if (op == TokenType::PERCENT)
+			{
+				// The remainder is closer to 0 than the divisor and has the sign of the dividend.
+				const i64 bound = std::max<i64>(std::max(-right.Min, right.Max) - 1, 0);
+
+				return {left.Min >= 0 ? 0 : std::max(left.Min, -bound), left.Max <= 0 ? 0 : std::min(left.Max, bound)};
+			}
+
+			// With a divisor of one sign, the quotients of the ends are the smallest and largest quotient.
+			if (!isOneSign)
+				return {};
+
+			const std::array<i64, 4> quotients = {left.Min / right.Min, left.Min / right.Max, left.Max / right.Min,
+			                                      left.Max / right.Max};
+			const auto [min, max] = std::minmax_element(quotients.begin(), quotients.end());
+
+			// INT_MIN / -1 does not fit.
+			return *max <= MaxInt32 ? Range{*min, *max} : Range{};
+		}
+
+		Range result;
+		bool isUnsigned = false; // Whether the u32 operation does not wrap around if the i32 one does not
+
+		switch (op)
+		{
+		case TokenType::PLUS:
+			result     = {left.Min + right.Min, left.Max + right.Max};
+			isUnsigned = left.Min >= 0 && right.Min >= 0;
+			break;
+		case TokenType::MINUS:
+			result     = {left.Min - right.Max, left.Max - right.Min};
+			isUnsigned = result.Min >= 0 && right.Min >= 0;
+			break;
+		case TokenType::STAR:
+		{
+			// The ends are i32, their products fit into an i64.
+			const std::array<i64, 4> products = {left.Min * right.Min, left.Min * right.Max, left.Max * right.Min,
+			                                     left.Max * right.Max};
+			const auto [min, max] = std::minmax_element(products.begin(), products.end());
+
+			result     = {*min, *max};
+			isUnsigned = left.Min >= 0 && right.Min >= 0;
+			break;
+		}
+		default:
+			return {};
+		}
+
+		if (result.Min < MinInt32 || result.Max > MaxInt32)
+			return {};
+
+		binary->AddFact(ArithmeticFact::NoSignedWrap);
+
+		if (isUnsigned)
+			binary->AddFact(ArithmeticFact::NoUnsignedWrap);
+
+		return result;
+	}
+
+	Sema::Range Sema::AnalyzePower(PowerExpression* power, const Range& base, const Range& exponent)
+	{
+		// Negative exponents are not raised to.
+		if (exponent.Min < 0)
+			return {};
+
+		// No power is further from 0 than the largest base to the largest exponent, x ** 0 is 1. Bases of 0 and 1
+		// stay at 1, others are past INT_MAX after 31 factors.
+		const i64 magnitude = std::max(-base.Min, base.Max);
+
+		i64 bound = 1;
+
+		if (magnitude > 1)
+		{
+			for (i64 i = 0; i < exponent.Max && bound <= MaxInt32; i++) bound *= magnitude;
+		}
+
+		if (bound > MaxInt32)
+			return {};
+
+		power->AddFact(ArithmeticFact::NoSignedWrap);
+
+		return {base.Min >= 0 ? 0 : -bound, bound};
+	}
+
+	Sema::Range Sema::PopRange()
+	{
+		ASSERT(!m_Ranges.empty(), "No range for the expression.");
+
+		const Range range = m_Ranges.back();
+		m_Ranges.pop_back();
+
+		return range;
+	}
+
+	void Sema::PushNarrowings(const IfStatement* ifStatement)
+	{
+		const Expression* condition = SkipGroupings(ifStatement->GetCondition());
+
+		const Expression* variable = condition;
+		TokenType op               = TokenType::BANG_EQUAL; // if $x is if $x != 0
+		i32 value                  = 0;
+
+		if (condition->GetKind() == NodeKind::BinaryExpression)
+		{
+			const auto* binary = static_cast<const BinaryExpression*>(condition);
+
+			const Expression* left  = SkipGroupings(binary->GetLeft());
+			const Expression* right = SkipGroupings(binary->GetRight());
+
+			op = binary->GetOperator();
+
+			// 3 < $x is $x > 3.
+			if (left->GetKind() == NodeKind::NumberLiteral)
+			{
+				std::swap(left, right);
+				op = MirrorComparison(op);
+			}
+
+			if (!IsComparisonOperator(op) || right->GetKind() != NodeKind::NumberLiteral)
+				return;
+
+			variable = left;
+			value    = Wrap(static_cast<u32>(static_cast<const NumberLiteral*>(right)->GetValue()));
+		}
+
+		if (variable->GetKind() != NodeKind::VariableExpression)
+			return;
+
+		const VariableID id = static_cast<const VariableExpression*>(variable)->GetVariable();
+
+		if (ifStatement->HasElseScope())
+			m_Narrowings.push_back({ifStatement->GetElseScope(), id, NegateComparison(op), value, Range{}});
+
+		m_Narrowings.push_back({ifStatement->GetThenScope(), id, op, value, Range{}});
+	}
+
+	void Sema::EnterScopeRanges(Scope* scope)
+	{
+		if (m_Narrowings.empty() || m_Narrowings.back().ScopeNode != scope)
+			return;
+
+		Narrowing& narrowing = m_Narrowings.back();
+		Range& range         = m_VariableRanges[narrowing.Variable];
+
+		narrowing.Saved = range;
+
+		const i64 value = narrowing.Value;
+		Range narrowed  = range;
+
+		switch (narrowing.Operator)
+		{
+		case TokenType::EQUAL_EQUAL:
+			narrowed = {std::max(range.Min, value), std::min(range.Max, value)};
+			break;
+		case TokenType::BANG_EQUAL:
+			// A value at an end of the range is cut off, of the values in between only 0 can be left out.
+			if (range.Min == value)
+				narrowed.Min++;
+			else if (range.Max == value)
+				narrowed.Max--;
+			else if (value == 0)
+				narrowed.IsNonZero = true;
+			break;
+		case TokenType::LESS:
+			narrowed.Max = std::min(range.Max, value - 1);
+			break;
+		case TokenType::LESS_EQUAL:
+			narrowed.Max = std::min(range.Max, value);
+			break;
+		case TokenType::GREATER:
+			narrowed.Min = std::max(range.Min, value + 1);
+			break;
+		case TokenType::GREATER_EQUAL:
+			narrowed.Min = std::max(range.Min, value);
+			break;
+		default:
+			break;
+		}
+
+		// No value reaches the scope then, it never runs.
+		if (narrowed.Min <= narrowed.Max)
+			range = narrowed;
+	}
+
+	void Sema::LeaveScopeRanges(Scope* scope)
+	{
+		// Expression statements left their ranges behind.
+		for (Statement* statement : scope->GetStatements())
+		{
+			if (IsExpression(statement->GetKind()))
+				PopRange();
+		}
+
+		if (m_Narrowings.empty() || m_Narrowings.back().ScopeNode != scope)
+			return;
+
+		m_VariableRanges[m_Narrowings.back().Variable] = m_Narrowings.back().Saved;
+		m_Narrowings.pop_back();
+	}
+
+	Sema::FoldedValue Sema::PopValue()
+	{
+		ASSERT(!m_Values.empty(), "No value for the expression.");
+
+		const FoldedValue value = m_Values.back();
+		m_Values.pop_back();
+
+		return value;
+	}
+
+	Expression* Sema::Materialize(const FoldedValue& value)
+	{
+		if (!value.IsConstant || value.Node->GetKind() == NodeKind::NumberLiteral)
+			return value.Node;
+
+		// Sign extended, so the literal holds the same value when it is read as a wider integer.
+		const u64 literal = static_cast<u64>(static_cast<i64>(value.Value));
+
+		return m_Ast.Arena.Create<NumberLiteral>(value.Node->GetLocation(), literal);
+	}
+} // namespace WandeltCore
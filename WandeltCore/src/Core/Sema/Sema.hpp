@@ -8,13 +8,136 @@
  */
 #pragma once
 
+#include "Core/AST/AST.hpp"
+#include "Core/Sema/SymbolTable.hpp"
+
 namespace WandeltCore
 {
+	// Semantic analysis of a parsed AST, before it is lowered. Changes the nodes in place, new nodes go into the
+	// arena of the AST. Walks the tree with explicit stacks, so deeply nested expressions do not overflow the
+	// native call stack.
 	class Sema
 	{
 	public:
+		explicit Sema(Ast& ast);
+
+		// Run all passes over the AST. Only ASTs without syntax errors belong in here. Returns whether the AST is
+		// free of semantic errors, the passes after the failed one are skipped otherwise.
+		bool Analyze();
+
+		// Number the declared variables and point every read at its declaration, in the innermost scope around
+		// the read that declared the name before it. Reports reads of undeclared variables and names declared
+		// twice in one scope. Returns whether every name resolved.
+		bool ResolveNames();
+
+		// Replace every constant subexpression by a NumberLiteral holding its value. Values are i32 like in
+		// codegen, so arithmetic wraps around. Divisions by zero and INT_MIN / -1 are undefined and stay for
+		// runtime. Reads of variables with a constant initializer are constant too. Needs the names resolved.
+		void FoldConstants();
+
+		// Replace if statements with a constant condition by the statements of the branch taken, and leave out the
+		// statements behind a return, they are never reached. Declarations of constant variables go too, their
+		// reads were folded. Needs the constants folded.
+		void EliminateDeadCode();
+
+		// Give every expression the type of its value. Comparisons are Bool, a grouping or a variable has the type
+		// of what it stands for, everything else is Int32. Needs the names resolved.
+		void InferTypes();
+
+		// Bound the values of every expression by an interval and record on the arithmetic what the intervals
+		// prove: that it does not wrap around, that a divisor is not 0 and that no INT_MIN is divided by -1. In
+		// the scopes of an if statement comparing a variable with a literal, the variable is narrowed to the values
+		// the comparison lets through. Values of calls are unbounded. Needs the dead code eliminated.
+		void AnalyzeRanges();
 
 	private:
+		// The folded value of a visited expression, waiting for its parent.
+		struct FoldedValue
+		{
+			Expression* Node = nullptr;
+			i32 Value        = 0;
+			bool IsConstant  = false;
+		};
+
+		// The values an expression can take, both ends included. The ends are i64, so i32 arithmetic on them can
+		// not overflow.
+		struct Range
+		{
+			i64 Min        = std::numeric_limits<i32>::min();
+			i64 Max        = std::numeric_limits<i32>::max();
+			bool IsNonZero = false; // 0 lies between the ends but is left out, in the scope of an if $x != 0
+		};
+
+		// A variable narrowed in a scope of an if statement, Variable Operator Value holds in the scope. Saved is
+		// the range of the variable outside of the scope.
+		struct Narrowing
+		{
+			Scope* ScopeNode    = nullptr;
+			VariableID Variable = InvalidVariableID;
+			TokenType Operator  = TokenType::EQUAL_EQUAL;
+			i32 Value           = 0;
+			Range Saved;
+		};
+
+		// A node on the walk stack. Scopes are no statements, they get entries of their own.
+		struct Entry
+		{
+			Statement* Node  = nullptr;
+			Scope* ScopeNode = nullptr;
+			bool IsExpanded  = false;
+		};
+
+		// Push the children of the node onto the walk stack, last to first so they come off in source order.
+		void PushChildren(Statement* statement);
+
+		// Give the declared variable the next number in the innermost scope, reports if the name is taken there.
+		bool DeclareVariable(VariableDeclaration* declaration);
+		bool ResolveVariable(VariableExpression* variable);
+
+		// Fold the node whose children were folded already, their values are on top of the value stack.
+		void FoldNode(Statement* statement);
+		void FoldScope(Scope* scope);
+
+		FoldedValue PopValue();
+
+		// Infer the type of the node from the types of its children.
+		void InferType(Statement* statement);
+
+		// Bound the node whose children were analyzed already, their ranges are on top of the range stack.
+		void AnalyzeRange(Statement* statement);
+		Range AnalyzeBinary(BinaryExpression* binary, const Range& left, const Range& right);
+		Range AnalyzePower(PowerExpression* power, const Range& base, const Range& exponent);
+
+		Range PopRange();
+
+		// Push the narrowings the condition of the if statement implies for its scopes, the then scope on top.
+		void PushNarrowings(const IfStatement* ifStatement);
+		void EnterScopeRanges(Scope* scope);
+		void LeaveScopeRanges(Scope* scope);
+
+		// The expression to put into the tree for the value, a new literal if it is constant.
+		Expression* Materialize(const FoldedValue& value);
+
+		// Append the statements of the list that are reached to m_LiveStatements, with the branch taken of constant
+		// if statements in their place. Returns whether that is any different from the list.
+		bool CollectLiveStatements(std::span<Statement* const> statements);
+
+	private:
+		Ast& m_Ast;
+
+		std::vector<Entry> m_Stack;        // Nodes still to visit, or to fold once their children are done
+		std::vector<FoldedValue> m_Values; // Values of the folded expressions their parent still needs
+
+		SymbolTable m_Symbols;                  // The variables declared in the scopes around the node being resolved
+		VariableID m_VariableCount = 0;         // Variables numbered so far
+		std::vector<FoldedValue> m_Variables;   // By variable, the folded initializer
+		std::vector<ValueType> m_VariableTypes; // By variable, the type of the initializer
+
+		std::vector<Range> m_Ranges;         // Ranges of the analyzed expressions their parent still needs
+		std::vector<Range> m_VariableRanges; // By variable, the range in the scope being analyzed
+		std::vector<Narrowing> m_Narrowings; // Of the scopes being analyzed and the ones pushed to come next
 
+		std::vector<Scope*> m_Scopes;             // Scopes in the order they are nested, outer ones first
+		std::vector<Statement*> m_LiveStatements; // The statements of the list being cleaned up that are reached
 	};
-}
+} // namespace WandeltCore
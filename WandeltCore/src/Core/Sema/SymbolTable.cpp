@@ -0,0 +1,109 @@
+#include "SymbolTable.hpp"
+
+namespace WandeltCore
+{
+	namespace
+	{
+		constexpr u32 InitialSlotCount = 16;
+
+		// Symbol ids are dense, mixing spreads neighbouring ids over the table.
+		u32 HashName(SymbolID name)
+		{
+			u32 hash = name * 0x9E3779B1u;
+
+			return hash ^ (hash >> 16);
+		}
+	} // namespace
+
+	void SymbolTable::PopScope()
+	{
+		ASSERT(m_Depth > 0, "No scope to pop.");
+
+		if (m_TableCount > 0 && m_Tables[m_TableCount - 1].Depth == m_Depth)
+		{
+			ScopeTable& table = m_Tables[--m_TableCount];
+
+			table.Count = 0;
+
+			// All slots are of an older generation now. Should the counter wrap around, they are emptied for real.
+			if (++table.Generation == 0)
+			{
+				std::fill(table.Slots.begin(), table.Slots.end(), Slot{});
+				table.Generation = 1;
+			}
+		}
+
+		m_Depth--;
+	}
+
+	VariableID SymbolTable::Declare(SymbolID name, VariableID variable)
+	{
+		// The first declaration of a scope takes the next table.
+		if (m_TableCount == 0 || m_Tables[m_TableCount - 1].Depth != m_Depth)
+		{
+			if (m_TableCount == m_Tables.size())
+				m_Tables.emplace_back().Slots.resize(InitialSlotCount);
+
+			m_Tables[m_TableCount++].Depth = m_Depth;
+		}
+
+		ScopeTable& table = m_Tables[m_TableCount - 1];
+		Slot& slot        = table.Slots[FindSlot(table, name)];
+
+		if (slot.Generation == table.Generation)
+			return slot.Variable;
+
+		slot = {name, variable, table.Generation};
+
+		if (++table.Count * 2 > table.Slots.size())
+			Grow(table);
+
+		return InvalidVariableID;
+	}
+
+	VariableID SymbolTable::Lookup(SymbolID name) const
+	{
+		for (u32 i = m_TableCount; i-- > 0;)
+		{
+			const ScopeTable& table = m_Tables[i];
+			const Slot& slot        = table.Slots[FindSlot(table, name)];
+
+			if (slot.Generation == table.Generation)
+				return slot.Variable;
+		}
+
+		return InvalidVariableID;
+	}
+
+	u32 SymbolTable::FindSlot(const ScopeTable& table, SymbolID name)
+	{
+		const u32 mask = static_cast<u32>(table.Slots.size()) - 1;
+
+		u32 index = HashName(name) & mask;
+
+		while (table.Slots[index].Generation == table.Generation && table.Slots[index].Name != name)
+			index = (index + 1) & mask;
+
+		return index;
+	}
+
+	void SymbolTable::Grow(ScopeTable& table)
+	{
+		std::vector<Slot> slots(table.Slots.size() * 2);
+		const u32 mask = static_cast<u32>(slots.size()) - 1;
+
+		for (const Slot& slot : table.Slots)
+		{
+			if (slot.Generation != table.Generation)
+				continue;
+
+			u32 index = HashName(slot.Name) & mask;
+
+			while (slots[index].Generation == table.Generation) index = (index + 1) & mask;
+
+			slots[index] = slot;
+		}
+
+		table.Slots = std::move(slots);
+	}
+} // namespace WandeltCore
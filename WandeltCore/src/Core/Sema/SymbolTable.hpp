@@ -0,0 +1,59 @@
+/**
+ * @file SymbolTable.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-09-28
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+#include "Core/AST/AST.hpp"
+
+namespace WandeltCore
+{
+	// Maps the interned names of variables to the variables they refer to, scope by scope. Every scope that
+	// declares names gets a flat open-addressing table of its own, so a lookup costs O(1) per enclosing scope
+	// that declares anything, however many names it declares. Scopes without declarations cost nothing. The
+	// tables of closed scopes are cleared in O(1) and reused by the next scopes, without allocating.
+	class SymbolTable
+	{
+	public:
+		void PushScope() { m_Depth++; }
+		void PopScope();
+
+		// Declare the name in the innermost scope. Returns the variable the name was declared as in that scope
+		// before, InvalidVariableID if it was not.
+		VariableID Declare(SymbolID name, VariableID variable);
+
+		// The variable the name refers to in the innermost scope declaring it, InvalidVariableID if none does.
+		VariableID Lookup(SymbolID name) const;
+
+	private:
+		struct Slot
+		{
+			SymbolID Name       = InvalidSymbolID;
+			VariableID Variable = InvalidVariableID;
+			u32 Generation      = 0; // Slots of another generation than their table are empty
+		};
+
+		struct ScopeTable
+		{
+			std::vector<Slot> Slots; // Power of two sized, at most half full
+			u32 Count      = 0;      // Names declared
+			u32 Generation = 1;      // Bumped to empty the table
+			u32 Depth      = 0;      // Nesting depth of the scope the table belongs to
+		};
+
+		// Index of the slot holding the name, or of the empty slot it goes into.
+		static u32 FindSlot(const ScopeTable& table, SymbolID name);
+
+		// Double the slots of the table and reinsert its names.
+		static void Grow(ScopeTable& table);
+
+	private:
+		std::vector<ScopeTable> m_Tables; // The first m_TableCount belong to open scopes, innermost last
+		u32 m_TableCount = 0;             // Tables in use
+		u32 m_Depth      = 0;             // Nesting depth of the innermost open scope
+	};
+} // namespace WandeltCore
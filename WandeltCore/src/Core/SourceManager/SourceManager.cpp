@@ -0,0 +1,181 @@
+#include "SourceManager.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <deque>
+
+#ifdef SW_SIMD_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace WandeltCore
+{
+	namespace
+	{
+		struct SourceFile
+		{
+			std::string Filename;
+			MappedFile Contents;
+			std::string_view Source; // View over the contents
+			std::vector<u32> LineStarts; // Offset of the first character of every line, LineStarts[0] == 0
+		};
+
+		// Deque so registering a new file never moves the contents handed out as string views.
+		std::deque<SourceFile> s_Files;
+
+		u32 CountNewlines(std::string_view source)
+		{
+			const char* data = source.data();
+			const size_t size = source.size();
+
+			u32 count = 0;
+			size_t i  = 0;
+
+#ifdef SW_SIMD_SSE2
+			const __m128i newline = _mm_set1_epi8('\n');
+
+			for (; i + 16 <= size; i += 16)
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				const u32 mask      = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+
+				count += std::popcount(mask);
+			}
+#endif
+
+			for (; i < size; ++i) count += data[i] == '\n';
+
+			return count;
+		}
+
+		void BuildLineTable(std::string_view source, std::vector<u32>& lineStarts)
+		{
+			const char* data = source.data();
+			const size_t size = source.size();
+
+			lineStarts.reserve(CountNewlines(source) + 1);
+			lineStarts.push_back(0);
+
+			size_t i = 0;
+
+#ifdef SW_SIMD_SSE2
+			const __m128i newline = _mm_set1_epi8('\n');
+
+			for (; i + 16 <= size; i += 16)
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				u32 mask            = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+
+				while (mask)
+				{
+					lineStarts.push_back(static_cast<u32>(i + std::countr_zero(mask) + 1));
+					mask &= mask - 1;
+				}
+			}
+#endif
+
+			for (; i < size; ++i)
+			{
+				if (data[i] == '\n')
+					lineStarts.push_back(static_cast<u32>(i + 1));
+			}
+		}
+	} // namespace
+
+	u16 SourceManager::AddFile(const std::string& filename, MappedFile contents)
+	{
+		ASSERT(s_Files.size() < InvalidFileID, "Too many source files registered.");
+		ASSERT(contents.GetView().size() < std::numeric_limits<u32>::max(), "Source file `{}` is too large.",
+		       filename);
+
+		SourceFile& file = s_Files.emplace_back();
+		file.Filename    = filename;
+		file.Contents    = std::move(contents);
+		file.Source      = file.Contents.GetView();
+
+		BuildLineTable(file.Source, file.LineStarts);
+
+		return static_cast<u16>(s_Files.size() - 1);
+	}
+
+	void SourceManager::ApplyEdit(u16 fileID, const SourceEdit& edit)
+	{
+		ASSERT(fileID < s_Files.size(), "Invalid file id: {}", fileID);
+
+		SourceFile& file = s_Files[fileID];
+
+		ASSERT(u64(edit.Offset) + edit.RemovedLength <= file.Source.size(), "Edit is outside of file `{}`.",
+		       file.Filename);
+
+		const u32 removedEnd = edit.Offset + edit.RemovedLength;
+
+		std::string source;
+		source.reserve(file.Source.size() - edit.RemovedLength + edit.Text.size());
+		source.append(file.Source.substr(0, edit.Offset));
+		source.append(edit.Text);
+		source.append(file.Source.substr(removedEnd));
+
+		ASSERT(source.size() < std::numeric_limits<u32>::max(), "Source file `{}` is too large.", file.Filename);
+
+		// Lines starting up to the edit stay, the ones starting in the removed text go and the ones behind it move.
+		const auto first = std::upper_bound(file.LineStarts.begin(), file.LineStarts.end(), edit.Offset);
+		const auto last  = std::upper_bound(first, file.LineStarts.end(), removedEnd);
+
+		for (auto it = last; it != file.LineStarts.end(); ++it) *it = *it - edit.RemovedLength + edit.Text.size();
+
+		std::vector<u32> insertedLineStarts;
+
+		for (size_t i = 0; i < edit.Text.size(); i++)
+		{
+			if (edit.Text[i] == '\n')
+				insertedLineStarts.push_back(static_cast<u32>(edit.Offset + i + 1));
+		}
+
+		const auto position = file.LineStarts.erase(first, last);
+		file.LineStarts.insert(position, insertedLineStarts.begin(), insertedLineStarts.end());
+
+		file.Contents = MappedFile(std::move(source));
+		file.Source   = file.Contents.GetView();
+	}
+
+	std::string_view SourceManager::GetFilename(u16 fileID)
+	{
+		ASSERT(fileID < s_Files.size(), "Invalid file id: {}", fileID);
+
+		return s_Files[fileID].Filename;
+	}
+
+	std::string_view SourceManager::GetSource(u16 fileID)
+	{
+		ASSERT(fileID < s_Files.size(), "Invalid file id: {}", fileID);
+
+		return s_Files[fileID].Source;
+	}
+
+	ResolvedLocation SourceManager::Resolve(const SourceLocation& location)
+	{
+		if (location.FileID == InvalidFileID)
+			return {}; // Synthesized nodes (e.g. the implicit return) have no file behind them
+
+		ASSERT(location.FileID < s_Files.size(), "Invalid file id: {}", location.FileID);
+
+		const SourceFile& file = s_Files[location.FileID];
+
+		// The last line start that is <= offset is the line the location is on.
+		const auto it   = std::upper_bound(file.LineStarts.begin(), file.LineStarts.end(), location.Offset);
+		const u32 line  = static_cast<u32>(it - file.LineStarts.begin());
+		const u32 start = file.LineStarts[line - 1];
+
+		// The line ends right before the start of the next one, or at the end of the file.
+		const u32 end =
+		    line < file.LineStarts.size() ? file.LineStarts[line] - 1 : static_cast<u32>(file.Source.size());
+
+		ResolvedLocation resolved;
+		resolved.Filename = file.Filename;
+		resolved.CodeLine = file.Source.substr(start, end - start);
+		resolved.Line     = line;
+		resolved.Column   = location.Offset - start + 1;
+
+		return resolved;
+	}
+} // namespace WandeltCore
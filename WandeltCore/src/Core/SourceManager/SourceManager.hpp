@@ -0,0 +1,50 @@
+/**
+ * @file SourceManager.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+#include "Core/FileSystem/FileSystem.hpp"
+
+namespace WandeltCore
+{
+	// Human readable form of a SourceLocation. Only computed when a diagnostic or a dump needs it.
+	struct ResolvedLocation
+	{
+		std::string_view Filename;
+		std::string_view CodeLine; // The entire line the location points into, without the newline
+		u32 Line   = 0;            // 1-based line number
+		u32 Column = 0;            // 1-based column number
+	};
+
+	// A change to the contents of a file: RemovedLength bytes at Offset are replaced by Text.
+	struct SourceEdit
+	{
+		u32 Offset        = 0;
+		u32 RemovedLength = 0;
+		std::string_view Text;
+	};
+
+	class SourceManager
+	{
+	public:
+		// Register the contents of a file under the given filename and build its line table. The SourceManager
+		// keeps the contents alive. Returns the id that SourceLocations into this file refer to.
+		static u16 AddFile(const std::string& filename, MappedFile contents);
+
+		// Apply the edit to the contents of the file and move its line table along. Views into the old
+		// contents of the file are invalidated.
+		static void ApplyEdit(u16 fileID, const SourceEdit& edit);
+
+		static std::string_view GetFilename(u16 fileID);
+		static std::string_view GetSource(u16 fileID);
+
+		// Turn a compact location into line, column and the text of the line it is on.
+		// Uses a binary search over the line table of the file.
+		static ResolvedLocation Resolve(const SourceLocation& location);
+	};
+} // namespace WandeltCore
@@ -0,0 +1,124 @@
+#include "StringInterner.hpp"
+
+namespace WandeltCore
+{
+	StringInterner::StringInterner() : m_Slots(1024)
+	{
+	}
+
+	SymbolID StringInterner::Intern(std::string_view text)
+	{
+		const u32 hash = Hash(text);
+		const u32 mask = static_cast<u32>(m_Slots.size()) - 1;
+
+		u32 index = hash & mask;
+
+		while (m_Slots[index].ID != InvalidSymbolID)
+		{
+			const Slot& slot = m_Slots[index];
+
+			if (slot.Hash == hash && m_Strings[slot.ID] == text)
+				return slot.ID;
+
+			index = (index + 1) & mask;
+		}
+
+		const SymbolID id = GetSize();
+
+		m_Strings.push_back(Store(text));
+		m_Slots[index] = {hash, id};
+
+		if (m_Strings.size() * 2 > m_Slots.size())
+			Grow();
+
+		return id;
+	}
+
+	std::string_view StringInterner::GetString(SymbolID id) const
+	{
+		ASSERT(id < m_Strings.size(), "Invalid symbol id {}.", id);
+
+		return m_Strings[id];
+	}
+
+	StringInterner& StringInterner::Get()
+	{
+		static StringInterner s_Interner;
+
+		return s_Interner;
+	}
+
+	std::string_view StringInterner::Store(std::string_view text)
+	{
+		const u32 size = static_cast<u32>(text.size());
+
+		if (size > m_BlockRemaining)
+		{
+			// Strings larger than a block get a block of their own.
+			const u32 blockSize = std::max(size, BlockSize);
+
+			m_Blocks.push_back(std::make_unique<char[]>(blockSize));
+			m_BlockCursor    = m_Blocks.back().get();
+			m_BlockRemaining = blockSize;
+		}
+
+		char* data = m_BlockCursor;
+		std::memcpy(data, text.data(), size);
+
+		m_BlockCursor += size;
+		m_BlockRemaining -= size;
+
+		return {data, size};
+	}
+
+	void StringInterner::Grow()
+	{
+		std::vector<Slot> slots(m_Slots.size() * 2);
+		const u32 mask = static_cast<u32>(slots.size()) - 1;
+
+		for (const Slot& slot : m_Slots)
+		{
+			if (slot.ID == InvalidSymbolID)
+				continue;
+
+			u32 index = slot.Hash & mask;
+
+			while (slots[index].ID != InvalidSymbolID) index = (index + 1) & mask;
+
+			slots[index] = slot;
+		}
+
+		m_Slots = std::move(slots);
+	}
+
+	u32 StringInterner::Hash(std::string_view text)
+	{
+		// Multiply-xorshift over 8 bytes at a time, names are short so this is a handful of multiplies.
+		constexpr u64 multiplier = 0x9E3779B97F4A7C15ull;
+
+		const char* data = text.data();
+		size_t size      = text.size();
+
+		u64 hash = size * multiplier;
+
+		for (; size >= 8; data += 8, size -= 8)
+		{
+			u64 word;
+			std::memcpy(&word, data, 8);
+
+			hash = (hash ^ word) * multiplier;
+			hash ^= hash >> 32;
+		}
+
+		if (size > 0)
+		{
+			u64 word = 0;
+			std::memcpy(&word, data, size);
+
+			hash = (hash ^ word) * multiplier;
+			hash ^= hash >> 32;
+		}
+
+		return static_cast<u32>(hash);
+	}
+} // namespace WandeltCore
@@ -0,0 +1,63 @@
+/**
+ * @file StringInterner.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+namespace WandeltCore
+{
+	// Id of an interned string. Equal strings get equal ids, so names compare as integers.
+	using SymbolID = u32;
+
+	constexpr SymbolID InvalidSymbolID = std::numeric_limits<SymbolID>::max();
+
+	// Stores every distinct string once and hands out dense ids in the order strings were first seen.
+	// Strings live in an arena of fixed blocks, so the views handed out stay valid for the lifetime of the
+	// interner, and are looked up through an open-addressing hash table with linear probing.
+	class StringInterner
+	{
+	public:
+		StringInterner();
+
+		// Id of the given string, interning a copy of it if it was not seen before.
+		SymbolID Intern(std::string_view text);
+
+		std::string_view GetString(SymbolID id) const;
+
+		// Number of distinct strings interned.
+		u32 GetSize() const { return static_cast<u32>(m_Strings.size()); }
+
+		// The interner shared by the compiler. Not synchronized, threads intern into their own instance
+		// and merge it into this one afterwards.
+		static StringInterner& Get();
+
+	private:
+		// Copy the string into the arena.
+		std::string_view Store(std::string_view text);
+
+		// Double the hash table and reinsert every string.
+		void Grow();
+
+		static u32 Hash(std::string_view text);
+
+	private:
+		struct Slot
+		{
+			u32 Hash    = 0;
+			SymbolID ID = InvalidSymbolID; // InvalidSymbolID marks an empty slot
+		};
+
+		static constexpr u32 BlockSize = 64 * 1024;
+
+		std::vector<Slot> m_Slots;               // Power of two sized, at most half full
+		std::vector<std::string_view> m_Strings; // Indexed by SymbolID
+
+		std::vector<std::unique_ptr<char[]>> m_Blocks; // Arena the interned strings are stored in
+		char* m_BlockCursor   = nullptr;               // Next free byte in the last block
+		u32 m_BlockRemaining = 0;                     // Free bytes left in the last block
+	};
+} // namespace WandeltCore
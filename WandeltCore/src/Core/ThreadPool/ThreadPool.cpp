@@ -0,0 +1,97 @@
+#include "ThreadPool.hpp"
+
+namespace WandeltCore
+{
+	ThreadPool::ThreadPool(u32 threadCount)
+	{
+		// The calling thread of ParallelFor is one of the threads.
+		for (u32 i = 1; i < threadCount; i++)
+			m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_IsStopping = true;
+		}
+
+		m_JobAvailable.notify_all();
+
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	void ThreadPool::ParallelFor(u32 count, const std::function<void(u32)>& job)
+	{
+		if (count == 0)
+			return;
+
+		if (count == 1 || m_Workers.empty())
+		{
+			for (u32 i = 0; i < count; i++)
+				job(i);
+
+			return;
+		}
+
+		u32 remaining = count; // Guarded by m_Mutex
+
+		std::unique_lock lock(m_Mutex);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			m_Jobs.emplace_back([&job, &remaining, i, this]() {
+				job(i);
+
+				std::lock_guard lock(m_Mutex);
+
+				if (--remaining == 0)
+					m_JobFinished.notify_all();
+			});
+		}
+
+		m_JobAvailable.notify_all();
+
+		// Help out instead of idling, then wait for the jobs other threads picked up.
+		while (remaining > 0)
+		{
+			if (!m_Jobs.empty())
+				RunJob(lock);
+			else
+				m_JobFinished.wait(lock);
+		}
+	}
+
+	ThreadPool& ThreadPool::Get()
+	{
+		static ThreadPool s_Pool(std::max(std::thread::hardware_concurrency(), 1u));
+
+		return s_Pool;
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		std::unique_lock lock(m_Mutex);
+
+		while (true)
+		{
+			m_JobAvailable.wait(lock, [this]() { return m_IsStopping || !m_Jobs.empty(); });
+
+			if (m_Jobs.empty())
+				return; // Stopping and nothing left to run
+
+			RunJob(lock);
+		}
+	}
+
+	void ThreadPool::RunJob(std::unique_lock<std::mutex>& lock)
+	{
+		std::function<void()> job = std::move(m_Jobs.front());
+		m_Jobs.pop_front();
+
+		lock.unlock();
+		job();
+		lock.lock();
+	}
+} // namespace WandeltCore
@@ -0,0 +1,49 @@
+/**
+ * @file ThreadPool.hpp
+ * @author SW
+ * @version 0.0.1
+ * @date 2024-10-19
+ *
+ * @copyright Copyright (c) 2024 SW
+ */
+#pragma once
+
+namespace WandeltCore
+{
+	// A fixed set of worker threads running jobs from a shared queue.
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool(u32 threadCount);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&)            = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Run job(i) for every i in [0, count) and return once all of them finished.
+		// The calling thread runs jobs too, so nested calls from inside a job cannot deadlock.
+		void ParallelFor(u32 count, const std::function<void(u32)>& job);
+
+		// Number of threads jobs run on, the worker threads and the calling thread.
+		u32 GetThreadCount() const { return static_cast<u32>(m_Workers.size()) + 1; }
+
+		// The pool shared by the compiler, one thread per hardware thread.
+		static ThreadPool& Get();
+
+	private:
+		void WorkerLoop();
+
+		// Pop and run one queued job. Expects the lock to be held, releases it while the job runs.
+		void RunJob(std::unique_lock<std::mutex>& lock);
+
+	private:
+		std::vector<std::thread> m_Workers;
+
+		std::deque<std::function<void()>> m_Jobs; // Jobs waiting for a thread
+		std::mutex m_Mutex;                       // Guards m_Jobs and m_IsStopping
+		std::condition_variable m_JobAvailable;   // Signalled when a job is queued or the pool stops
+		std::condition_variable m_JobFinished;    // Signalled when a job finished
+
+		bool m_IsStopping = false;
+	};
+} // namespace WandeltCore
@@ -15,11 +15,15 @@
 
 namespace WandeltCore
 {
+	// Id of a location that does not belong to any file registered in the SourceManager.
+	constexpr u16 InvalidFileID = std::numeric_limits<u16>::max();
+
+	// Compact location in the source. Line, column and the code line are resolved lazily
+	// through the SourceManager, only when a diagnostic or a dump needs them.
 	struct SourceLocation
 	{
-		std::string_view Filepath;
-		u32 Line;
-		u32 Column;
+		u16 FileID = InvalidFileID; // Id of the file in the SourceManager
+		u32 Offset = 0;             // Byte offset from the start of the file
 	};
 
 	[[nodiscard]] static std::string getIndent(u32 level, u32 multiplier = 2)
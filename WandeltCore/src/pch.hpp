@@ -1,13 +1,27 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <Core/Defines.hpp>
 #include <Core/Error.hpp>
 #include <Core/Utils.hpp>
+#include <Core/SourceManager/SourceManager.hpp>
+#include <Core/StringInterner/StringInterner.hpp>
 
 #include <Logger/Logger.hpp>